@@ -1,78 +1,138 @@
+import json
 import os
 from pathlib import Path
+import sys
 import time
 
 INPUT_PATH: Path = Path("sdcard/shaders")
 OUTPUT_PATH: Path = Path("sdcard/output")
 RYUJINX_PATH: Path = Path(os.environ["APPDATA"]) / Path("ryujinx")
 TIMEOUT: float = 10.0
+FORMATS: tuple[str, ...] = ("nv", "raw", "constbuf")
+
+class CompileError(Exception):
+    """Raised when the compiler published a diagnostics file instead of binaries"""
+    def __init__(self, name: str, result: dict) -> None:
+        self.name: str = name
+        self.result: dict = result
+        super().__init__(format_diagnostics(name, result))
+
+def format_diagnostics(name: str, result: dict) -> str:
+    lines: list[str] = [
+        f"{name}: compilation failed ({result['reason']}, read {result['read_us'] / 1000:.1f}ms, compile {result['compile_us'] / 1000:.1f}ms)"
+    ]
+    for diagnostic in result["diagnostics"]:
+        file: str = os.path.basename(diagnostic["file"]) if diagnostic["file"] else name
+        location: str = f"{file}:{diagnostic['line']}" if diagnostic["line"] >= 0 else file
+        lines.append(f"{location}: {diagnostic['severity']}: {diagnostic['message']}")
+    return "\n".join(lines)
+
+# (control, code, diagnostics, completion marker)
+OutputPaths = tuple[Path, Path, Path, Path]
+# (control, code, derived formats)
+Compiled = tuple[bytes, bytes, dict[str, bytes]]
+
+def get_output_paths(name: str) -> OutputPaths:
+    return (
+        RYUJINX_PATH / OUTPUT_PATH / Path(f"{name}.bin.control"),
+        RYUJINX_PATH / OUTPUT_PATH / Path(f"{name}.bin.code"),
+        RYUJINX_PATH / OUTPUT_PATH / Path(f"{name}.bin.diagnostics"),
+        RYUJINX_PATH / OUTPUT_PATH / Path(f"{name}.bin.done"),
+    )
+
+def get_format_path(name: str, format: str) -> Path:
+    return RYUJINX_PATH / OUTPUT_PATH / Path(f"{name}.bin.code.{format}")
+
+def write_input(name: str, source: bytes, formats: set[str]) -> None:
+    input: Path = RYUJINX_PATH / INPUT_PATH / Path(name)
+    # the format request has to be in place before the shader itself is picked up
+    if formats:
+        Path(f"{input}.formats").write_text(" ".join(sorted(formats)))
+    input.write_bytes(source)
 
-def compile_shaders(names: list[str], sources: list[bytes]) -> list[tuple[bytes, bytes]]:
-    inputs: list[Path] = []
-    outputs: list[tuple[Path, Path]] = []
+def remove_input(name: str) -> None:
+    input: Path = RYUJINX_PATH / INPUT_PATH / Path(name)
+    input.unlink(missing_ok=True)
+    Path(f"{input}.formats").unlink(missing_ok=True)
+
+def is_finished(output: OutputPaths) -> bool:
+    # the completion marker is renamed into place after every other output of the job, for failed compiles as well
+    return os.path.exists(output[3])
+
+def read_output(name: str, output: OutputPaths, formats: set[str]) -> Compiled:
+    # marker contents are "<sequence> ok|failed"
+    if output[3].read_text().split()[1] != "ok":
+        raise CompileError(name, json.loads(output[2].read_bytes()))
+    # derived formats are sliced out on the device, shaders without constants have no constbuf output
+    derived: dict[str, bytes] = {}
+    for format in formats:
+        if os.path.exists(get_format_path(name, format)):
+            derived[format] = get_format_path(name, format).read_bytes()
+    return (output[0].read_bytes(), output[1].read_bytes(), derived)
+
+def remove_output(name: str, output: OutputPaths) -> None:
+    for path in output:
+        path.unlink(missing_ok=True)
+    for format in FORMATS:
+        get_format_path(name, format).unlink(missing_ok=True)
+
+def compile_shaders(names: list[str], sources: list[bytes], formats: set[str]) -> list[Compiled | CompileError]:
+    outputs: list[OutputPaths] = []
     for i, name in enumerate(names):
-        inputs.append(RYUJINX_PATH / INPUT_PATH / Path(name))
-        outputs.append((
-            RYUJINX_PATH / OUTPUT_PATH / Path(f"{name}.bin.control"),
-            RYUJINX_PATH / OUTPUT_PATH / Path(f"{name}.bin.code"),
-        ))
-        inputs[i].write_bytes(sources[i])
+        outputs.append(get_output_paths(name))
+        write_input(name, sources[i], formats)
     start: float = time.time()
-    while not all(os.path.exists(output[0]) and os.path.exists(output[1]) for output in outputs) and time.time() - start < TIMEOUT: ...
-    time.sleep(0.1)
-    compiled: list[tuple[bytes, bytes]] = []
+    while not all(is_finished(output) for output in outputs) and time.time() - start < TIMEOUT:
+        time.sleep(0.1)
+    compiled: list[Compiled | CompileError] = []
     try:
-        for output in outputs:
-            compiled.append((output[0].read_bytes(), output[1].read_bytes()))
+        for name, output in zip(names, outputs):
+            try:
+                compiled.append(read_output(name, output, formats))
+            except CompileError as e:
+                compiled.append(e)
     finally:
-        for i in inputs:
-            os.unlink(i)
-        for o in outputs:
-            os.unlink(o[0])
-            os.unlink(o[1])
+        for name, output in zip(names, outputs):
+            remove_input(name)
+            remove_output(name, output)
     return compiled
 
-def get_shader_size(control: bytes) -> int:
-    return int.from_bytes(control[0x6f8:0x6fc], "little")
-
-def get_shader_offset(control: bytes) -> int:
-    return int.from_bytes(control[0x708:0x70c], "little")
-
-def get_constbuf_size(control: bytes) -> int:
-    return int.from_bytes(control[0x6fc:0x700], "little")
-
-def get_constbuf_offset(control: bytes) -> int:
-    return int.from_bytes(control[0x700:0x704], "little")
-
-def is_compute(control: bytes) -> bool:
-    return int.from_bytes(control[0x714:0x718], "little") == 5 # NVN_SHADER_STAGE_COMPUTE
-
-def compile_shader(name: str, source: bytes) -> tuple[bytes, bytes]:
-    input: Path = RYUJINX_PATH / INPUT_PATH / Path(name)
-    control: Path = RYUJINX_PATH / OUTPUT_PATH / Path(f"{name}.bin.control")
-    code: Path = RYUJINX_PATH / OUTPUT_PATH / Path(f"{name}.bin.code")
-    input.write_bytes(source)
+def compile_shader(name: str, source: bytes, formats: set[str]) -> Compiled:
+    output: OutputPaths = get_output_paths(name)
+    write_input(name, source, formats)
     start: float = time.time()
-    while not os.path.exists(control) and not os.path.exists(code) and time.time() - start < TIMEOUT: ...
-    time.sleep(0.1)
+    while not is_finished(output) and time.time() - start < TIMEOUT:
+        time.sleep(0.1)
     try:
-        compiled: tuple[bytes, bytes] = (control.read_bytes(), code.read_bytes())
+        compiled: Compiled = read_output(name, output, formats)
     finally:
-        os.unlink(input)
-        os.unlink(control)
-        os.unlink(code)
+        remove_input(name)
+        remove_output(name, output)
     return compiled
 
+def write_outputs(output: str, path: str, basename: str, compiled: Compiled, formats: set[str]) -> None:
+    with open(os.path.join(output, f"{basename}.bin.ctrl"), "wb") as f:
+        f.write(compiled[0])
+    with open(os.path.join(output, f"{basename}.bin.code"), "wb") as f:
+        f.write(compiled[1])
+    for format in formats:
+        if format in compiled[2]:
+            with open(os.path.join(output, f"{basename}.bin.code.{format}"), "wb") as f:
+                f.write(compiled[2][format])
+        elif format == "constbuf":
+            print(f"{path} has no constants to output, skipping")
+        else:
+            print(f"{path} is missing its {format} output", file=sys.stderr)
+
 def main() -> None:
     import argparse
-    import sys
 
     parser: argparse.ArgumentParser = argparse.ArgumentParser("shader-compile", description="Script to compile NVN shaders - Ryujinx should be running in the background already")
     parser.add_argument("--input", "-i", nargs="+", required=True)
     parser.add_argument("--output", "-o", default="")
     parser.add_argument("--ryujinx", "-r", help="Path to Ryujinx directory so that Ryujinx/sdcard exists", default=os.path.join(os.environ["APPDATA"], "ryujinx"))
     parser.add_argument(
-        "--format", "-f", nargs="+", choices=("nv", "raw", "constbuf"), default=[],
+        "--format", "-f", nargs="+", choices=FORMATS, default=[],
         help="Additional format to output shaders in (nv = including Nvidia Shader Header, raw = code only, constbuf = shader constants buffer)"
     )
     
@@ -96,34 +156,13 @@ def main() -> None:
         source: bytes = Path(path).read_bytes()
         basename: str = os.path.basename(path)
 
-        compiled: tuple[bytes, bytes] = compile_shader(basename, source)
-
-        with open(os.path.join(output, f"{basename}.bin.ctrl"), "wb") as f:
-            f.write(compiled[0])
-        with open(os.path.join(output, f"{basename}.bin.code"), "wb") as f:
-            f.write(compiled[1])
-        for format in formats:
-            if format == "nv":
-                shader_size: int = get_shader_size(compiled[0])
-                shader_offset: int = get_shader_offset(compiled[0])
-                with open(os.path.join(output, f"{basename}.bin.code.nv"), "wb") as f:
-                    f.write(compiled[1][shader_offset:shader_offset+shader_size])
-            elif format == "raw":
-                shader_size: int = get_shader_size(compiled[0])
-                shader_offset: int = get_shader_offset(compiled[0])
-                with open(os.path.join(output, f"{basename}.bin.code.raw"), "wb") as f:
-                    if is_compute(compiled[0]): # compute shaders don't have the shader program header
-                        f.write(compiled[1][shader_offset:shader_offset+shader_size])
-                    else:
-                        f.write(compiled[1][shader_offset+0x50:shader_offset+shader_size])
-            elif format == "constbuf":
-                constbuf_size: int = get_constbuf_size(compiled[0])
-                constbuf_offset: int = get_constbuf_offset(compiled[0])
-                if constbuf_size > 0:
-                    with open(os.path.join(output, f"{basename}.bin.code.constbuf"), "wb") as f:
-                        f.write(compiled[1][constbuf_offset:constbuf_offset+constbuf_size])
-                else:
-                    print(f"{path} has no constants to output, skipping")
+        try:
+            compiled: Compiled = compile_shader(basename, source, formats)
+        except CompileError as e:
+            print(e, file=sys.stderr)
+            sys.exit(1)
+
+        write_outputs(output, path, basename, compiled, formats)
     else:
         sources: list[bytes] = []
         basenames: list[str] = []
@@ -131,35 +170,18 @@ def main() -> None:
             sources.append(Path(path).read_bytes())
             basenames.append(os.path.basename(path))
         
-        compiled: list[tuple[bytes, bytes]] = compile_shaders(basenames, sources)
+        compiled: list[Compiled | CompileError] = compile_shaders(basenames, sources, formats)
 
+        failed: bool = False
         for i in range(len(sources)):
-            with open(os.path.join(output, f"{basenames[i]}.bin.ctrl"), "wb") as f:
-                f.write(compiled[i][0])
-            with open(os.path.join(output, f"{basenames[i]}.bin.code"), "wb") as f:
-                f.write(compiled[i][1])
-            for format in formats:
-                if format == "nv":
-                    shader_size: int = get_shader_size(compiled[i][0])
-                    shader_offset: int = get_shader_offset(compiled[i][0])
-                    with open(os.path.join(output, f"{basenames[i]}.bin.code.nv"), "wb") as f:
-                        f.write(compiled[i][1][shader_offset:shader_offset+shader_size])
-                elif format == "raw":
-                    shader_size: int = get_shader_size(compiled[i][0])
-                    shader_offset: int = get_shader_offset(compiled[i][0])
-                    with open(os.path.join(output, f"{basenames[i]}.bin.code.raw"), "wb") as f:
-                        if is_compute(compiled[i][0]):
-                            f.write(compiled[i][1][shader_offset:shader_offset+shader_size])
-                        else:
-                            f.write(compiled[i][1][shader_offset+0x50:shader_offset+shader_size])
-                elif format == "constbuf":
-                    constbuf_size: int = get_constbuf_size(compiled[i][0])
-                    constbuf_offset: int = get_constbuf_offset(compiled[i][0])
-                    if constbuf_size > 0:
-                        with open(os.path.join(output, f"{basenames[i]}.bin.code.constbuf"), "wb") as f:
-                            f.write(compiled[i][1][constbuf_offset:constbuf_offset+constbuf_size])
-                    else:
-                        print(f"{paths[i]} has no constants to output, skipping")
+            if isinstance(compiled[i], CompileError):
+                print(compiled[i], file=sys.stderr)
+                failed = True
+                continue
+            write_outputs(output, paths[i], basenames[i], compiled[i], formats)
+
+        if failed:
+            sys.exit(1)
 
 if __name__ == "__main__":
     main()
\ No newline at end of file
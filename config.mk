@@ -22,6 +22,10 @@ NPDM_JSON := qlaunch.json
 C_FLAGS := 
 CXX_FLAGS := 
 
+# Whether to pack relative relocations into DT_RELR, which is much smaller than RELA. Needs binutils 2.38+. (0/1)
+# Only for AsRtld, Module builds are relocated by the system's rtld which ignores DT_RELR.
+PACK_RELATIVE_RELOCS := 0
+
 # AsRtld settings
 #------------------------
 
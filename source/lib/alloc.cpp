@@ -0,0 +1,92 @@
+#include "alloc.hpp"
+
+#include <cerrno>
+#include <mutex>
+#include <reent.h>
+
+#include <common.hpp>
+#include <program/setting.hpp>
+
+#include "util/sys/spin_lock.hpp"
+
+#ifdef EXL_USE_FAKEHEAP
+
+namespace exl::alloc {
+
+    namespace {
+        constinit Tlsf s_FakeHeap;
+        /* Hooks and loggers may allocate from any thread. */
+        constinit util::SpinLock s_FakeHeapLock;
+
+        /* Failures are reported through the caller's errno, like newlib's own allocator does. */
+        void* SetErrnoOnFailure(struct _reent* reent, void* ptr) {
+            if (ptr == nullptr)
+                reent->_errno = ENOMEM;
+            return ptr;
+        }
+    }
+
+    TlsfStats GetFakeHeapStats() {
+        std::scoped_lock lock(s_FakeHeapLock);
+        return s_FakeHeap.GetStats();
+    }
+
+    namespace impl {
+        void InitializeFakeHeap(void* arena, size_t size) {
+            std::scoped_lock lock(s_FakeHeapLock);
+            s_FakeHeap.Initialize(arena, size);
+        }
+    }
+}
+
+/* Override newlib's reentrant allocator entrypoints, malloc/free/etc. are thin wrappers around these. */
+extern "C" {
+
+    void* _malloc_r(struct _reent* reent, size_t size) {
+        std::scoped_lock lock(exl::alloc::s_FakeHeapLock);
+        return exl::alloc::SetErrnoOnFailure(reent, exl::alloc::s_FakeHeap.Allocate(size));
+    }
+
+    void _free_r(struct _reent*, void* ptr) {
+        std::scoped_lock lock(exl::alloc::s_FakeHeapLock);
+        exl::alloc::s_FakeHeap.Free(ptr);
+    }
+
+    void* _realloc_r(struct _reent* reent, void* ptr, size_t size) {
+        std::scoped_lock lock(exl::alloc::s_FakeHeapLock);
+        void* newPtr = exl::alloc::s_FakeHeap.Reallocate(ptr, size);
+        /* Reallocating to zero frees, so null isn't a failure then. */
+        if (size == 0 && ptr != nullptr)
+            return newPtr;
+        return exl::alloc::SetErrnoOnFailure(reent, newPtr);
+    }
+
+    void* _calloc_r(struct _reent* reent, size_t count, size_t size) {
+        size_t total;
+        if (__builtin_mul_overflow(count, size, &total))
+            return exl::alloc::SetErrnoOnFailure(reent, nullptr);
+
+        void* ptr;
+        {
+            std::scoped_lock lock(exl::alloc::s_FakeHeapLock);
+            ptr = exl::alloc::SetErrnoOnFailure(reent, exl::alloc::s_FakeHeap.Allocate(total));
+        }
+
+        if (ptr != nullptr)
+            std::memset(ptr, 0, total);
+        return ptr;
+    }
+
+    void* _memalign_r(struct _reent* reent, size_t align, size_t size) {
+        std::scoped_lock lock(exl::alloc::s_FakeHeapLock);
+        return exl::alloc::SetErrnoOnFailure(reent, exl::alloc::s_FakeHeap.Allocate(size, align));
+    }
+
+    size_t _malloc_usable_size_r(struct _reent*, void* ptr) {
+        /* The size shares its word with flags that frees and allocations of the neighbouring block update. */
+        std::scoped_lock lock(exl::alloc::s_FakeHeapLock);
+        return exl::alloc::s_FakeHeap.GetAllocationSize(ptr);
+    }
+}
+
+#endif
\ No newline at end of file
@@ -1,10 +1,12 @@
 #pragma once
 
+#include <cstddef>
+
+#include "alloc/tlsf.hpp"
+
 /* Require an externally linked heap implementation to be provided if fake heap isn't used. */
 #ifndef EXL_USE_FAKEHEAP
 
-#include <cstddef>
-
 extern "C" {
 
 extern void *malloc(size_t size);
@@ -12,4 +14,14 @@ extern void *aligned_alloc( size_t alignment, size_t size );
 
 };
 
-#endif
\ No newline at end of file
+#endif
+
+namespace exl::alloc {
+
+    /* Only available with EXL_USE_FAKEHEAP, where the fake heap backs malloc and friends. */
+    TlsfStats GetFakeHeapStats();
+
+    namespace impl {
+        void InitializeFakeHeap(void* arena, size_t size);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,372 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstring>
+
+#include "types.h"
+
+namespace exl::alloc {
+
+    struct TlsfStats {
+        size_t m_ArenaSize;
+        size_t m_UsedSize;
+        size_t m_PeakUsedSize;
+        size_t m_FreeSize;
+        size_t m_FreeBlockCount;
+        size_t m_AllocCount;
+        size_t m_FreeCount;
+        size_t m_FailCount;
+    };
+
+    /*
+        Two-level segregated fit allocator over a single caller-provided arena.
+        Allocation and free are O(1): free blocks are binned by a (first level, second level) size class,
+        and a pair of bitmaps finds the smallest non-empty bin that is guaranteed to fit a request.
+        Not thread safe, callers are expected to provide their own locking.
+    */
+    class Tlsf {
+        public:
+        static constexpr size_t Alignment = 0x10;
+
+        private:
+        static constexpr u32 SlLog2 = 4;
+        static constexpr u32 SlCount = 1 << SlLog2;
+        static constexpr u32 FlShift = SlLog2 + std::countr_zero(Alignment);
+        static constexpr u32 FlIndexMax = 32;
+        static constexpr u32 FlCount = FlIndexMax - FlShift + 1;
+        static constexpr size_t SmallBlockSize = size_t(1) << FlShift;
+        static constexpr size_t MaxBlockSize = (size_t(1) << FlIndexMax) - Alignment;
+
+        static constexpr size_t FlagFree = 1 << 0;
+        static constexpr size_t FlagPrevFree = 1 << 1;
+        static constexpr size_t FlagMask = Alignment - 1;
+
+        struct Block {
+            /* Only valid when the previous physical block is free. */
+            size_t m_PrevSize;
+            /* Size of the block including this header, low bits hold flags. */
+            size_t m_SizeAndFlags;
+            /* Only valid when this block is free. */
+            Block* m_NextFree;
+            Block* m_PrevFree;
+
+            constexpr size_t GetSize() const { return m_SizeAndFlags & ~FlagMask; }
+            constexpr void SetSize(size_t size) { m_SizeAndFlags = size | (m_SizeAndFlags & FlagMask); }
+            constexpr bool IsFree() const { return m_SizeAndFlags & FlagFree; }
+            constexpr bool IsPrevFree() const { return m_SizeAndFlags & FlagPrevFree; }
+
+            Block* GetNext() { return reinterpret_cast<Block*>(reinterpret_cast<uintptr_t>(this) + GetSize()); }
+            Block* GetPrev() { return reinterpret_cast<Block*>(reinterpret_cast<uintptr_t>(this) - m_PrevSize); }
+        };
+
+        static constexpr size_t HeaderSize = offsetof(Block, m_NextFree);
+        static constexpr size_t MinBlockSize = sizeof(Block);
+        static_assert(HeaderSize == Alignment, "Block header must preserve allocation alignment.");
+        static_assert(FlCount <= BITSIZEOF(u32), "First level bitmap is too small.");
+        static_assert(SlCount <= BITSIZEOF(u32), "Second level bitmap is too small.");
+
+        uintptr_t m_ArenaStart = 0;
+        uintptr_t m_ArenaEnd = 0;
+        u32 m_FlBitmap = 0;
+        u32 m_SlBitmaps[FlCount] = {};
+        Block* m_FreeLists[FlCount][SlCount] = {};
+        TlsfStats m_Stats = {};
+
+        static constexpr void MapInsert(size_t size, u32& fl, u32& sl) {
+            if (size < SmallBlockSize) {
+                fl = 0;
+                sl = static_cast<u32>(size / (SmallBlockSize / SlCount));
+            } else {
+                const u32 log2 = BITSIZEOF(size_t) - 1 - std::countl_zero(size);
+                sl = static_cast<u32>(size >> (log2 - SlLog2)) ^ SlCount;
+                fl = log2 - (FlShift - 1);
+            }
+        }
+
+        /* Rounds up to the next bin boundary so that any block in the resulting bin will fit. */
+        static constexpr void MapSearch(size_t size, u32& fl, u32& sl) {
+            if (size >= SmallBlockSize) {
+                const u32 log2 = BITSIZEOF(size_t) - 1 - std::countl_zero(size);
+                size += (size_t(1) << (log2 - SlLog2)) - 1;
+            }
+            MapInsert(size, fl, sl);
+        }
+
+        static constexpr size_t GetAdjustedSize(size_t size) {
+            const size_t adjusted = ALIGN_UP(size, Alignment) + HeaderSize;
+            return adjusted < MinBlockSize ? MinBlockSize : adjusted;
+        }
+
+        static Block* FromPointer(const void* ptr) {
+            return reinterpret_cast<Block*>(reinterpret_cast<uintptr_t>(ptr) - HeaderSize);
+        }
+
+        static void* ToPointer(Block* block) {
+            return reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(block) + HeaderSize);
+        }
+
+        static void MarkFree(Block* block) {
+            block->m_SizeAndFlags |= FlagFree;
+            Block* next = block->GetNext();
+            next->m_SizeAndFlags |= FlagPrevFree;
+            next->m_PrevSize = block->GetSize();
+        }
+
+        static void MarkUsed(Block* block) {
+            block->m_SizeAndFlags &= ~FlagFree;
+            block->GetNext()->m_SizeAndFlags &= ~FlagPrevFree;
+        }
+
+        void InsertFree(Block* block) {
+            u32 fl, sl;
+            MapInsert(block->GetSize(), fl, sl);
+
+            Block* head = m_FreeLists[fl][sl];
+            block->m_NextFree = head;
+            block->m_PrevFree = nullptr;
+            if (head != nullptr)
+                head->m_PrevFree = block;
+            m_FreeLists[fl][sl] = block;
+
+            m_FlBitmap |= 1u << fl;
+            m_SlBitmaps[fl] |= 1u << sl;
+            m_Stats.m_FreeBlockCount++;
+        }
+
+        void RemoveFree(Block* block) {
+            u32 fl, sl;
+            MapInsert(block->GetSize(), fl, sl);
+
+            if (block->m_NextFree != nullptr)
+                block->m_NextFree->m_PrevFree = block->m_PrevFree;
+            if (block->m_PrevFree != nullptr)
+                block->m_PrevFree->m_NextFree = block->m_NextFree;
+            else
+                m_FreeLists[fl][sl] = block->m_NextFree;
+
+            if (m_FreeLists[fl][sl] == nullptr) {
+                m_SlBitmaps[fl] &= ~(1u << sl);
+                if (m_SlBitmaps[fl] == 0)
+                    m_FlBitmap &= ~(1u << fl);
+            }
+            m_Stats.m_FreeBlockCount--;
+        }
+
+        Block* FindFree(size_t size) {
+            u32 fl, sl;
+            MapSearch(size, fl, sl);
+
+            u32 slMap = fl < FlCount ? m_SlBitmaps[fl] & (~0u << sl) : 0;
+            if (slMap == 0) {
+                const u32 flMap = fl + 1 < FlCount ? m_FlBitmap & (~0u << (fl + 1)) : 0;
+                if (flMap == 0) {
+                    /* Nothing is guaranteed to fit, but the head of the exact bin still might. */
+                    MapInsert(size, fl, sl);
+                    Block* head = fl < FlCount ? m_FreeLists[fl][sl] : nullptr;
+                    return head != nullptr && head->GetSize() >= size ? head : nullptr;
+                }
+
+                fl = std::countr_zero(flMap);
+                slMap = m_SlBitmaps[fl];
+            }
+            sl = std::countr_zero(slMap);
+            return m_FreeLists[fl][sl];
+        }
+
+        /* Splits the tail off a block that isn't in a free list and returns it to the free lists. */
+        void Trim(Block* block, size_t size) {
+            const size_t remainderSize = block->GetSize() - size;
+            if (remainderSize < MinBlockSize)
+                return;
+
+            block->SetSize(size);
+            Block* remainder = block->GetNext();
+            remainder->m_SizeAndFlags = remainderSize;
+
+            /* The following block may already be free if a used block is being shrunk. */
+            Block* next = remainder->GetNext();
+            if (next->IsFree()) {
+                RemoveFree(next);
+                remainder->SetSize(remainderSize + next->GetSize());
+            }
+
+            MarkFree(remainder);
+            InsertFree(remainder);
+        }
+
+        public:
+        constexpr Tlsf() = default;
+        Tlsf(const Tlsf&) = delete;
+        Tlsf& operator=(const Tlsf&) = delete;
+
+        bool Initialize(void* arena, size_t size) {
+            const uintptr_t start = ALIGN_UP(arena, Alignment);
+            const uintptr_t end = ALIGN_DOWN(reinterpret_cast<uintptr_t>(arena) + size, Alignment);
+            if (end <= start || end - start < MinBlockSize + HeaderSize)
+                return false;
+
+            /* Reserve a header at the end as a sentinel so that every block has a physical successor. */
+            size_t blockSize = end - start - HeaderSize;
+            if (blockSize > MaxBlockSize)
+                blockSize = MaxBlockSize;
+
+            m_FlBitmap = 0;
+            std::memset(m_SlBitmaps, 0, sizeof(m_SlBitmaps));
+            std::memset(m_FreeLists, 0, sizeof(m_FreeLists));
+            m_Stats = {};
+            m_Stats.m_ArenaSize = blockSize;
+            m_Stats.m_FreeSize = blockSize;
+
+            Block* block = reinterpret_cast<Block*>(start);
+            block->m_PrevSize = 0;
+            block->m_SizeAndFlags = blockSize;
+
+            Block* sentinel = block->GetNext();
+            sentinel->m_SizeAndFlags = 0;
+
+            MarkFree(block);
+            InsertFree(block);
+
+            m_ArenaStart = start;
+            m_ArenaEnd = start + blockSize + HeaderSize;
+            return true;
+        }
+
+        bool IsInitialized() const {
+            return m_ArenaStart != 0;
+        }
+
+        bool Contains(const void* ptr) const {
+            const uintptr_t address = reinterpret_cast<uintptr_t>(ptr);
+            return m_ArenaStart <= address && address < m_ArenaEnd;
+        }
+
+        void* Allocate(size_t size, size_t align = Alignment) {
+            if (align < Alignment)
+                align = Alignment;
+
+            if (!IsInitialized() || size > MaxBlockSize || !std::has_single_bit(align) || align > MaxBlockSize) {
+                m_Stats.m_FailCount++;
+                return nullptr;
+            }
+
+            /* Over-allocate for larger alignments so that a leading free block can always be split off. */
+            const size_t adjusted = GetAdjustedSize(size);
+            const size_t searchSize = align > Alignment ? adjusted + align + MinBlockSize : adjusted;
+
+            Block* block = FindFree(searchSize);
+            if (block == nullptr) {
+                m_Stats.m_FailCount++;
+                return nullptr;
+            }
+            RemoveFree(block);
+
+            if (align > Alignment) {
+                const uintptr_t ptr = reinterpret_cast<uintptr_t>(ToPointer(block));
+                uintptr_t aligned = ALIGN_UP(ptr, align);
+                if (aligned != ptr && aligned - ptr < MinBlockSize)
+                    aligned = ALIGN_UP(ptr + MinBlockSize, align);
+
+                const size_t gap = aligned - ptr;
+                if (gap != 0) {
+                    Block* alignedBlock = reinterpret_cast<Block*>(reinterpret_cast<uintptr_t>(block) + gap);
+                    alignedBlock->m_SizeAndFlags = block->GetSize() - gap;
+                    block->SetSize(gap);
+                    MarkFree(block);
+                    InsertFree(block);
+                    block = alignedBlock;
+                }
+            }
+
+            Trim(block, adjusted);
+            MarkUsed(block);
+
+            m_Stats.m_UsedSize += block->GetSize();
+            m_Stats.m_FreeSize -= block->GetSize();
+            if (m_Stats.m_UsedSize > m_Stats.m_PeakUsedSize)
+                m_Stats.m_PeakUsedSize = m_Stats.m_UsedSize;
+            m_Stats.m_AllocCount++;
+            return ToPointer(block);
+        }
+
+        void Free(void* ptr) {
+            if (ptr == nullptr)
+                return;
+
+            Block* block = FromPointer(ptr);
+            m_Stats.m_UsedSize -= block->GetSize();
+            m_Stats.m_FreeSize += block->GetSize();
+            m_Stats.m_FreeCount++;
+
+            if (block->IsPrevFree()) {
+                Block* prev = block->GetPrev();
+                RemoveFree(prev);
+                prev->SetSize(prev->GetSize() + block->GetSize());
+                block = prev;
+            }
+
+            Block* next = block->GetNext();
+            if (next->IsFree()) {
+                RemoveFree(next);
+                block->SetSize(block->GetSize() + next->GetSize());
+            }
+
+            MarkFree(block);
+            InsertFree(block);
+        }
+
+        void* Reallocate(void* ptr, size_t size) {
+            if (ptr == nullptr)
+                return Allocate(size);
+
+            if (size == 0) {
+                Free(ptr);
+                return nullptr;
+            }
+
+            if (size > MaxBlockSize) {
+                m_Stats.m_FailCount++;
+                return nullptr;
+            }
+
+            Block* block = FromPointer(ptr);
+            const size_t oldSize = block->GetSize();
+            const size_t adjusted = GetAdjustedSize(size);
+
+            /* Try to grow in place by absorbing the following free block. */
+            if (adjusted > oldSize) {
+                Block* next = block->GetNext();
+                if (!next->IsFree() || oldSize + next->GetSize() < adjusted) {
+                    void* newPtr = Allocate(size);
+                    if (newPtr == nullptr)
+                        return nullptr;
+
+                    std::memcpy(newPtr, ptr, oldSize - HeaderSize);
+                    Free(ptr);
+                    return newPtr;
+                }
+
+                RemoveFree(next);
+                block->SetSize(oldSize + next->GetSize());
+                MarkUsed(block);
+            }
+
+            Trim(block, adjusted);
+
+            m_Stats.m_UsedSize = m_Stats.m_UsedSize - oldSize + block->GetSize();
+            m_Stats.m_FreeSize = m_Stats.m_FreeSize + oldSize - block->GetSize();
+            if (m_Stats.m_UsedSize > m_Stats.m_PeakUsedSize)
+                m_Stats.m_PeakUsedSize = m_Stats.m_UsedSize;
+            return ptr;
+        }
+
+        size_t GetAllocationSize(const void* ptr) const {
+            return FromPointer(ptr)->GetSize() - HeaderSize;
+        }
+
+        const TlsfStats& GetStats() const {
+            return m_Stats;
+        }
+    };
+}
\ No newline at end of file
@@ -16,6 +16,11 @@ namespace exl::armv8::inst::impl::op101x {
             BL = 1,
         };
 
+        /* The immediate is a signed word offset, anything further away needs an indirect branch. */
+        static constexpr bool IsInRange(s64 relative_address) {
+            return -(s64(1) << 27) <= relative_address && relative_address < (s64(1) << 27);
+        }
+
         constexpr UnconditionalBranchImmediate(Op op, uint relative_address) : Op101xInstruction(Op0) {
             SetOp(op);
             SetImm26(relative_address / 4);
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "base.hpp"
+
+namespace exl::armv8::inst {
+
+    struct BranchLinkRegister : public impl::op101x::UnconditionalBranchRegister {
+
+        static constexpr u8 Opc = 0b0001;
+        static constexpr u8 Op2 = 0b11111;
+        static constexpr u8 Op3 = 0b000000;
+        static constexpr u8 Op4 = 0b00000;
+
+        constexpr BranchLinkRegister(reg::Register rn) : UnconditionalBranchRegister(Opc, Op2) {
+            /*
+                static_assert(rn.Is64());
+            */
+
+            SetOp3(Op3);
+            SetRn(rn.Index());
+            SetOp4(Op4);
+        }
+    };
+
+    static_assert(BranchLinkRegister(reg::X0).Value()  == 0xD63F0000, "");
+    static_assert(BranchLinkRegister(reg::X1).Value()  == 0xD63F0020, "");
+    static_assert(BranchLinkRegister(reg::X16).Value() == 0xD63F0200, "");
+    static_assert(BranchLinkRegister(reg::X17).Value() == 0xD63F0220, "");
+}
\ No newline at end of file
@@ -5,8 +5,14 @@
 #include "log_types.hpp"
 
 #include <program/setting.hpp>
+#include <lib/armv8.hpp>
 #include <lib/log/logger_mgr.hpp>
+#include <lib/reloc/symbolizer.hpp>
+#include <lib/util/sys/mem_layout.hpp>
+#include <lib/util/stack_trace.hpp>
+#include <lib/util/strings.hpp>
 #include <program/loggers.hpp>
+#include <atomic>
 #include <cstdarg>
 #include <cinttypes>
 
@@ -14,7 +20,52 @@ namespace exl::diag {
 
     namespace {
 
+        #if defined(EXL_DEBUG)
+        constexpr size_t StackTraceDepthMax = 32;
+
+        void LogStackTrace() {
+            /* Symbolizing could abort again, in which case the second trace is skipped. It also can't wait on the symbolizer, the abort may have come from within it. */
+            static constinit std::atomic<bool> s_Logging;
+            if(s_Logging.exchange(true))
+                return;
+
+            /* The frame chain never leaves the current thread's stack, which is a single mapping. */
+            const auto fp = util::stack_trace::GetFp();
+            MemoryInfo meminfo {};
+            u32 pageinfo;
+            if(R_FAILED(svcQueryMemory(&meminfo, &pageinfo, fp)))
+                return;
+
+            Logging.Log("Stack Trace");
+            util::stack_trace::Iterator it(fp, util::Range { meminfo.addr, meminfo.size });
+            for(size_t i = 0; i < StackTraceDepthMax && it.Step(); i++) {
+                const auto lr = it.GetReturnAddress();
+
+                reloc::SymbolizedAddress info;
+                if(!reloc::TrySymbolize(lr, &info)) {
+                    Logging.Log("    #%02lu %016lx", i, lr);
+                    continue;
+                }
+
+                char nameBuffer[util::ModuleInfo::s_ModulePathLengthMax+1];
+                util::CopyString(nameBuffer, util::GetModuleInfo(info.m_Module).GetModuleName());
+                if(info.m_SymbolName != nullptr)
+                    Logging.Log("    #%02lu %016lx [%s]+%lx (%s+%lx)", i, lr, nameBuffer, info.m_ModuleOffset, info.m_SymbolName, info.m_SymbolOffset);
+                else
+                    Logging.Log("    #%02lu %016lx [%s]+%lx", i, lr, nameBuffer, info.m_ModuleOffset);
+            }
+            Logging.Log("");
+        }
+        #endif
+
         inline NORETURN void AbortWithCtx(const AbortCtx & ctx) {
+            #if defined(EXL_DEBUG)
+            LogStackTrace();
+            #endif
+
+            /* Make sure buffered log records describing the abort make it out. */
+            Logging.Flush();
+
             #ifdef EXL_SUPPORTS_REBOOTPAYLOAD
             /* Ensure abort handler doesn't recursively abort. */
             static std::atomic<bool> recurse_guard;
@@ -10,6 +10,7 @@
 #include <program/loggers.hpp>
 
 #include "nx64/impl.hpp"
+#include "stats.hpp"
 
 #define _HOOK_STATIC_CALLBACK_ASSERT() \
     static_assert(!std::is_member_function_pointer_v<CallbackFuncPtr<>>, "Callback method must be static!")
@@ -57,17 +58,67 @@ namespace exl::hook {
         return Hook(adapted.GetPtr(nullptr), callback, do_trampoline);
     }
 
+    /*
+        Restores the instructions a hook with a trampoline replaced, and recycles the trampoline for later hooks.
+        Patching isn't atomic and the trampoline may be reused right away, so nothing may be executing either of them.
+    */
+    template<typename CallbackPtr>
+    requires (!std::is_member_function_pointer_v<CallbackPtr>)
+    void Unhook(CallbackPtr trampoline) {
+        arch::Unhook(std::bit_cast<uintptr_t>(trampoline));
+    }
+
+    /*
+        Defers the cache maintenance of every hook installed or uninstalled while it is alive,
+        and does it in one pass over the touched ranges when the outermost transaction goes out of scope.
+        Hooks are not guaranteed to take effect before that.
+    */
+    class Transaction {
+        NON_COPYABLE(Transaction);
+        NON_MOVEABLE(Transaction);
+
+        public:
+        Transaction() {
+            arch::BeginTransaction();
+        }
+
+        ~Transaction() {
+            arch::CommitTransaction();
+        }
+    };
+
     using InlineCtx = arch::InlineCtx;
     using InlineCallback = util::CFuncPtr<void, InlineCtx*>;
 
     using InlineFloatCtx = arch::InlineFloatCtx;
     using InlineFloatCallback = util::CFuncPtr<void, InlineFloatCtx*>;
 
-    inline void HookInline(uintptr_t hook, InlineCallback callback) {
-        arch::HookInline(hook, reinterpret_cast<uintptr_t>(callback), false);
+    /* Returns a handle to the installed hook for UnhookInline. */
+    inline uintptr_t HookInline(uintptr_t hook, InlineCallback callback) {
+        return arch::HookInline(hook, reinterpret_cast<uintptr_t>(callback), false);
+    }
+
+    inline uintptr_t HookInline(uintptr_t hook, InlineFloatCallback callback) {
+        return arch::HookInline(hook, reinterpret_cast<uintptr_t>(callback), true);
+    }
+
+    /* Uninstalls an inline hook and recycles its entry, the same restrictions as for Unhook apply. */
+    inline void UnhookInline(uintptr_t handle) {
+        arch::UnhookInline(handle);
+    }
+
+    template<u8... Regs>
+    using InlineRegCtx = arch::InlineRegCtx<Regs...>;
+    template<u8... Regs>
+    using InlineRegCallback = util::CFuncPtr<void, InlineRegCtx<Regs...>*>;
+
+    /* Lightweight variant that only preserves the registers named in the callback's context, see InlineRegCtx for the caveats. */
+    template<u8... Regs>
+    inline uintptr_t HookInline(uintptr_t hook, InlineRegCallback<Regs...> callback) {
+        return arch::HookInlineRegs(hook, reinterpret_cast<uintptr_t>(callback), InlineRegCtx<Regs...>::Mask);
     }
 
-    inline void HookInline(uintptr_t hook, InlineFloatCallback callback) {
-        arch::HookInline(hook, reinterpret_cast<uintptr_t>(callback), true);
+    inline void UnhookInlineRegs(uintptr_t handle) {
+        arch::UnhookInlineRegs(handle);
     }
 }
\ No newline at end of file
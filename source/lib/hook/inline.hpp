@@ -1,6 +1,7 @@
 #pragma once
 
 #include <common.hpp>
+#include <utility>
 
 #include "base.hpp"
 
@@ -15,16 +16,31 @@ namespace exl::hook::impl {
         template<typename T = Derived>
         using CallbackFuncPtr = decltype(&T::Callback);
 
+        static ALWAYS_INLINE auto& HandleRef() {
+            static constinit uintptr_t s_Handle = 0;
+
+            return s_Handle;
+        }
+
         static ALWAYS_INLINE void InstallAtOffset(ptrdiff_t address) {
             _HOOK_STATIC_CALLBACK_ASSERT();
 
-            hook::HookInline(util::modules::GetTargetStart() + address, Derived::Callback);
+            HandleRef() = hook::HookInline(util::modules::GetTargetStart() + address, GetCallback<Derived>());
         }
 
         static ALWAYS_INLINE void InstallAtPtr(uintptr_t ptr) {
             _HOOK_STATIC_CALLBACK_ASSERT();
             
-            hook::HookInline(ptr, Derived::Callback);
+            HandleRef() = hook::HookInline(ptr, GetCallback<Derived>());
+        }
+
+        static ALWAYS_INLINE void Uninstall() {
+            _HOOK_STATIC_CALLBACK_ASSERT();
+
+            if constexpr(std::is_same_v<CallbackFuncPtr<>, InlineCallback> || std::is_same_v<CallbackFuncPtr<>, InlineFloatCallback>)
+                hook::UnhookInline(std::exchange(HandleRef(), 0));
+            else
+                hook::UnhookInlineRegs(std::exchange(HandleRef(), 0));
         }
 
     };
@@ -0,0 +1,87 @@
+#include "code_flush.hpp"
+
+#include <algorithm>
+#include <array>
+#include <mutex>
+
+#include "../../util/sys/spin_lock.hpp"
+
+namespace exl::hook::nx64 {
+
+    namespace {
+        struct Range {
+            uintptr_t m_Start;
+            uintptr_t m_End;
+        };
+
+        /* Pending ranges are merged when this fills up, and only flushed early if merging doesn't free anything. */
+        constexpr size_t MaxPendingRanges = 128;
+        /* Cache maintenance works on whole lines, so ranges sharing a line cost the same as one. */
+        constexpr uintptr_t CacheLineSize = 0x40;
+
+        constinit util::SpinLock s_Lock;
+        constinit s32 s_Depth = 0;
+        constinit size_t s_PendingCount = 0;
+        constinit std::array<Range, MaxPendingRanges> s_Pending {};
+
+        void FlushNow(uintptr_t start, uintptr_t end) {
+            /* Cleans the data cache and invalidates the instruction cache by address, then synchronizes. */
+            __builtin___clear_cache(reinterpret_cast<char*>(start), reinterpret_cast<char*>(end));
+        }
+
+        /* Sorts the pending ranges and merges the ones that overlap or share a cache line. */
+        void Coalesce() {
+            auto begin = s_Pending.begin();
+            std::sort(begin, begin + s_PendingCount, [](const Range& lhs, const Range& rhs) {
+                return lhs.m_Start < rhs.m_Start;
+            });
+
+            size_t count = 0;
+            for(size_t i = 0; i < s_PendingCount; i++) {
+                const Range& range = s_Pending[i];
+                if(count != 0 && ALIGN_DOWN(range.m_Start, CacheLineSize) <= ALIGN_UP(s_Pending[count - 1].m_End, CacheLineSize)) {
+                    s_Pending[count - 1].m_End = std::max(s_Pending[count - 1].m_End, range.m_End);
+                } else {
+                    s_Pending[count++] = range;
+                }
+            }
+            s_PendingCount = count;
+        }
+
+        void FlushPending() {
+            Coalesce();
+            for(size_t i = 0; i < s_PendingCount; i++)
+                FlushNow(s_Pending[i].m_Start, s_Pending[i].m_End);
+            s_PendingCount = 0;
+        }
+    }
+
+    void FlushCode(uintptr_t rx, size_t size) {
+        std::scoped_lock lock(s_Lock);
+
+        if(s_Depth == 0) {
+            FlushNow(rx, rx + size);
+            return;
+        }
+
+        if(s_PendingCount == MaxPendingRanges) {
+            Coalesce();
+            if(s_PendingCount == MaxPendingRanges)
+                FlushPending();
+        }
+        s_Pending[s_PendingCount++] = { rx, rx + size };
+    }
+
+    void BeginTransaction() {
+        std::scoped_lock lock(s_Lock);
+        s_Depth++;
+    }
+
+    void CommitTransaction() {
+        std::scoped_lock lock(s_Lock);
+        EXL_ASSERT(s_Depth > 0, "No transaction to commit!");
+
+        if(--s_Depth == 0)
+            FlushPending();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <common.hpp>
+
+namespace exl::hook::nx64 {
+
+    /* Makes code written through a RW view visible to instruction fetches from rx. Deferred while a transaction is open. */
+    void FlushCode(uintptr_t rx, size_t size);
+
+    /* Transactions nest, pending ranges are flushed once the outermost one is committed. */
+    void BeginTransaction();
+    void CommitTransaction();
+}
\ No newline at end of file
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace exl::hook::nx64 {
+
+    /*
+        Relocation of the instructions displaced by a hook into its trampoline.
+        This only depends on the standard library, so it can be built and exercised on the host as well.
+    */
+
+    constexpr int64_t MaxInstructions = 5;
+    constexpr uint64_t MaxReferences = MaxInstructions * 2;
+    /* Worst case output size for a single relocated instruction, including alignment padding. */
+    constexpr size_t MaxFixedInstructionSize = 10;
+    /* Worst case size of the branch back to the original code that ends the output. */
+    constexpr size_t MaxBranchBackSize = 5;
+    constexpr uint32_t Aarch64Nop = 0xd503201f;
+
+    /* Output size needed to relocate count instructions. */
+    constexpr size_t GetFixedInstructionsSize(int32_t count) {
+        return count * MaxFixedInstructionSize + MaxBranchBackSize;
+    }
+
+    /*
+        Copies count instructions read from inprw, which execute at inprx, to outrw, which will execute at outrx,
+        rewriting every PC-relative instruction for its new address, followed by a branch back to inprx + count.
+        The output must have room for GetFixedInstructionsSize(count) instructions.
+        Returns false without writing anything if count exceeds MaxInstructions.
+    */
+    bool __fix_instructions(uint32_t* __restrict inprw, uint32_t* __restrict inprx, int32_t count,
+                            uint32_t* __restrict outrw, uint32_t* __restrict outrx);
+}
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "common.hpp"
+#include "code_flush.hpp"
 #include "inline_impl.hpp"
 
 namespace exl::hook::nx64 {
@@ -8,5 +9,15 @@ namespace exl::hook::nx64 {
     void Initialize();
 
     uintptr_t Hook(uintptr_t hook, uintptr_t callback, bool do_trampoline = false);
-    void HookInline(uintptr_t hook, uintptr_t callback, bool capture_floats);
+    /* Reserves a trampoline ahead of hooking, so code branching to it can be written before the hooked site is patched. */
+    uintptr_t AllocateTrampoline();
+    /* Hook with a trampoline from AllocateTrampoline, or none if it's 0. Returns the trampoline. */
+    uintptr_t HookWithTrampoline(uintptr_t hook, uintptr_t callback, uintptr_t trampoline);
+    void Unhook(uintptr_t trampoline);
+    uintptr_t HookInline(uintptr_t hook, uintptr_t callback, bool capture_floats);
+    void UnhookInline(uintptr_t entry);
+
+    /* Mask selects the registers preserved around the callback, see InlineRegCtx. */
+    uintptr_t HookInlineRegs(uintptr_t hook, uintptr_t callback, u32 mask);
+    void UnhookInlineRegs(uintptr_t entry);
 }
\ No newline at end of file
@@ -103,7 +103,7 @@ CODE_BEGIN exl_inline_hook_impl
     /* Load inline context for the first argument of the callback. */
     mov x0, sp
     /* Load then call callback. */
-    ldr x20, [x19, #0x8]
+    ldr x20, [x19, #0xC]
     blr x20
 
     /* Keep a hold of entry pointer before restoring all the registers. */
@@ -125,7 +125,7 @@ CODE_BEGIN exl_inline_float_hook_impl
     /* Load inline context for the first argument of the callback. */
     mov x0, sp
     /* Load then call callback. */
-    ldr x20, [x19, #0x8]
+    ldr x20, [x19, #0xC]
     blr x20
 
     /* Keep a hold of entry pointer before restoring all the registers. */
@@ -4,7 +4,9 @@
 #include <array>
 
 #include "../../util/sys/jit.hpp"
+#include "../../util/sys/jit_pool.hpp"
 #include "../../armv8.hpp"
+#include "code_flush.hpp"
 #include "impl.hpp"
 
 namespace exl::hook::nx64 {
@@ -17,14 +19,23 @@ namespace exl::hook::nx64 {
     namespace inst = exl::armv8::inst;
 
     struct Entry {
-        std::array<inst::Instruction, 4> m_CbEntry;
+        std::array<inst::Instruction, 6> m_CbEntry;
         uintptr_t m_Callback;
+        /* Literals for when the impl or trampoline are out of reach of an immediate branch. */
+        uintptr_t m_Impl;
+        /* Also kept so the hook can be uninstalled. */
+        uintptr_t m_Trampoline;
+        uintptr_t m_Rw;
     };
+    /* The impl finds the callback relative to the return address of the call, which is the same for both forms of the entrypoint. */
+    static constexpr size_t EntryReturnOffset = 3 * sizeof(armv8::InstType);
+    static_assert(offsetof(Entry, m_Callback) - EntryReturnOffset == 0xC, "inline_asm.s expects the callback right after the entrypoint!");
 
-    static constexpr size_t InlinePoolCount = setting::InlinePoolSize / sizeof(Entry);
+    using EntryPool = util::JitSlotPool<sizeof(Entry), setting::JitGrowSize>;
 
     JIT_CREATE(s_InlineHookJit, setting::InlinePoolSize);
-    static size_t s_EntryIndex = 0;
+    /* Starts out with s_InlineHookJit, grows once that's used up. */
+    static constinit EntryPool s_EntryPool;
 
     extern "C" {
         extern char exl_inline_hook_impl;
@@ -39,32 +50,22 @@ namespace exl::hook::nx64 {
         }
     }
 
-    static const Entry* GetEntryRx() {
-        return reinterpret_cast<const Entry*>(s_InlineHookJit.GetRo());
-    }
-
-    static Entry* GetEntryRw() {
-        return reinterpret_cast<Entry*>(s_InlineHookJit.GetRw());
-    }
-
     void InitializeInline() {
         s_InlineHookJit.Initialize();
+        s_EntryPool.Initialize(s_InlineHookJit.GetRo(), s_InlineHookJit.GetRw(), s_InlineHookJit.GetSize());
     }
 
-    void HookInline(uintptr_t hook, uintptr_t callback, bool capture_floats) {
-        /* Ensure enough space in the pool. */
-        if(s_EntryIndex >= InlinePoolCount)
-            R_ABORT_UNLESS(result::HookTrampolineAllocFail);
-
-        /* Grab entry from pool. */
-        auto entryRx = &GetEntryRx()[s_EntryIndex];
-        auto entryRw = &GetEntryRw()[s_EntryIndex];
-        s_EntryIndex++;
+    uintptr_t HookInline(uintptr_t hook, uintptr_t callback, bool capture_floats) {
+        /* Grab entry from pool, recycling removed ones or mapping more if needed. */
+        EntryPool::Slot slot;
+        R_ABORT_UNLESS(s_EntryPool.Allocate(&slot));
+        auto entryRx = reinterpret_cast<const Entry*>(slot.m_Rx);
+        auto entryRw = reinterpret_cast<Entry*>(slot.m_Rw);
 
         /* Get pointer to entry's entrypoint. */
         uintptr_t entryCb = reinterpret_cast<uintptr_t>(&entryRx->m_CbEntry);
-        /* Hook to call into the entry's entrypoint. Assign trampoline to be used by impl. */
-        auto trampoline = Hook(hook, entryCb, true);
+        /* Reserve the trampoline up front, the entry has to be complete before the hook can reach it. */
+        auto trampoline = AllocateTrampoline();
         /* Offset of LR before SP is moved. */
         static constexpr int lrBackupOffset = int(offsetof(InlineCtx, m_Gpr.m_Lr)) - CtxStackBaseSize;
         static_assert(lrBackupOffset == -0x10, "InlineCtx is not ABI compatible.");
@@ -76,21 +77,60 @@ namespace exl::hook::nx64 {
         /* Select appropriate implementation for entrypoint. */
         auto impl = GetImpl(capture_floats);
 
+        /* Pool chunks can be mapped anywhere, so go through IP1 when a branch is out of reach. This clobbers X17, the same as HookFuncImpl does for far hooks. */
+        auto instOffset = [entryCb](size_t index) { return entryCb + index * sizeof(armv8::InstType); };
+        auto literalOffset = [&](size_t index, size_t offset) { return reinterpret_cast<uintptr_t>(entryRx) + offset - instOffset(index); };
+        const s64 implOffset = s64(impl) - s64(instOffset(2));
+        const s64 trampolineOffset = s64(trampoline) - s64(instOffset(4));
+
         /* Construct entrypoint instructions. */
-        entryRw->m_CbEntry = {
-            /* Backup LR register to stack, as we are about to trash it. */
-            inst::SturUnscaledImmediate(reg::LR, reg::SP, lrBackupOffset),
-            /* Branch to implementation. */
-            inst::BranchLink(impl - (entryCb + (1 * sizeof(armv8::InstType)))),
-            /* Restore proper LR. */
-            inst::LdurUnscaledImmediate(reg::LR, reg::SP, lrBackupOffset),
-            /* Branch to trampoline. */
-            inst::Branch(trampoline - (entryCb + (3 * sizeof(armv8::InstType))))
-        };
+        auto& code = entryRw->m_CbEntry;
+        /* Backup LR register to stack, as we are about to trash it. */
+        code[0] = inst::SturUnscaledImmediate(reg::LR, reg::SP, lrBackupOffset);
+        /* Branch to implementation. */
+        if(inst::BranchLink::IsInRange(implOffset)) {
+            code[1] = inst::Nop();
+            code[2] = inst::BranchLink(implOffset);
+        } else {
+            code[1] = inst::LdrLiteral(reg::X17, literalOffset(1, offsetof(Entry, m_Impl)));
+            code[2] = inst::BranchLinkRegister(reg::X17);
+        }
+        /* Restore proper LR. */
+        code[3] = inst::LdurUnscaledImmediate(reg::LR, reg::SP, lrBackupOffset);
+        /* Branch to trampoline. */
+        if(inst::Branch::IsInRange(trampolineOffset)) {
+            code[4] = inst::Branch(trampolineOffset);
+            code[5] = inst::Nop();
+        } else {
+            code[4] = inst::LdrLiteral(reg::X17, literalOffset(4, offsetof(Entry, m_Trampoline)));
+            code[5] = inst::BranchRegister(reg::X17);
+        }
         /* Assign callback to be called to be used by impl. */
         entryRw->m_Callback = callback;
+        entryRw->m_Impl = impl;
+        entryRw->m_Trampoline = trampoline;
+        entryRw->m_Rw = slot.m_Rw;
+
+        /* Flush caches to have the entry's RX view be consistent. */
+        FlushCode(reinterpret_cast<uintptr_t>(entryRx), sizeof(Entry));
+
+        /* Finally, hook to call into the entry's entrypoint. The trampoline is filled in before the hooked site is patched. */
+        HookWithTrampoline(hook, entryCb, trampoline);
+
+        return slot.m_Rx;
+    }
+
+    void UnhookInline(uintptr_t entry) {
+        EXL_ABORT_UNLESS(entry != 0);
+
+        auto entryRx = reinterpret_cast<const Entry*>(entry);
+        auto entryRw = reinterpret_cast<Entry*>(entryRx->m_Rw);
+        EXL_ABORT_UNLESS(entryRx->m_Trampoline != 0, "Inline hook was already uninstalled!");
+
+        /* Restore the hooked instructions first, nothing can reach the entry after that. */
+        Unhook(entryRx->m_Trampoline);
 
-        /* Finally, flush caches to have RX region to be consistent. */
-        s_InlineHookJit.Flush();
+        entryRw->m_Trampoline = 0;
+        s_EntryPool.Release({ entry, entryRx->m_Rw });
     }
 }
\ No newline at end of file
@@ -2,6 +2,8 @@
 
 #include <common.hpp>
 
+#include <bit>
+
 #include "../../util/neon.hpp"
 
 namespace exl::hook::nx64 {
@@ -157,5 +159,37 @@ namespace exl::hook::nx64 {
         }
     };
 
+    /*
+        Context for inline hooks that only preserve the general purpose registers in Regs, laid out in ascending register order.
+        Any other caller saved register, including every float register, may be clobbered by the callback, so this is only
+        suitable for hook sites where those are dead.
+    */
+    template<u8... Regs>
+    struct InlineRegCtx {
+        static_assert(sizeof...(Regs) != 0, "At least one register must be captured!");
+        static_assert(((Regs < 31) && ...), "Only X0 to X30 can be captured!");
+
+        static constexpr u32 Mask = ((1u << Regs) | ...);
+        static_assert(std::popcount(Mask) == sizeof...(Regs), "Registers must not be repeated!");
+
+        GpRegister m_Gp[sizeof...(Regs)];
+
+        template<u8 Reg>
+        static constexpr size_t IndexOf() {
+            static_assert(((Reg == Regs) || ...), "Register is not captured by this context!");
+            return std::popcount(Mask & ((1u << Reg) - 1));
+        }
+
+        template<u8 Reg>
+        ALWAYS_INLINE u64& X() {
+            return m_Gp[IndexOf<Reg>()].X;
+        }
+
+        template<u8 Reg>
+        ALWAYS_INLINE u32& W() {
+            return m_Gp[IndexOf<Reg>()].W;
+        }
+    };
+
     void InitializeInline();
 }
\ No newline at end of file
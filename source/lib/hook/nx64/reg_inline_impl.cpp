@@ -0,0 +1,123 @@
+
+#include <common.hpp>
+
+#include <array>
+#include <bit>
+#include <cstring>
+
+#include "../../util/sys/jit_pool.hpp"
+#include "../../armv8.hpp"
+#include "code_flush.hpp"
+#include "impl.hpp"
+
+namespace exl::hook::nx64 {
+
+    namespace reg = exl::armv8::reg;
+    namespace inst = exl::armv8::inst;
+
+    /* A store and a load for every register, the frame setup and teardown, the call, the branch back, padding and the literals. */
+    static constexpr size_t MaxRegEntryInstructions = 31 * 2 + 2 + 3 + 2 + 1 + 2 + 2;
+
+    /* Unlike regular entries, the whole entrypoint is generated per hook as it depends on the captured registers. */
+    struct RegEntry {
+        std::array<inst::Instruction, MaxRegEntryInstructions> m_Code;
+        /* Not used by the entrypoint, only kept so the hook can be uninstalled. */
+        uintptr_t m_Trampoline;
+        uintptr_t m_Rw;
+    };
+
+    using RegEntryPool = util::JitSlotPool<sizeof(RegEntry), setting::JitGrowSize>;
+
+    /* Has no static area, so builds that don't use these hooks don't pay for them. */
+    static constinit RegEntryPool s_RegEntryPool;
+
+    uintptr_t HookInlineRegs(uintptr_t hook, uintptr_t callback, u32 mask) {
+        /* LR is always preserved as the entry calls the callback. It's the highest register, so the context layout is unaffected. */
+        const u32 saved = mask | (1u << reg::LR.Index());
+        const u32 frameSize = ALIGN_UP(std::popcount(saved) * sizeof(u64), 0x10);
+
+        /* Grab entry from pool, recycling removed ones or mapping more if needed. */
+        RegEntryPool::Slot slot;
+        R_ABORT_UNLESS(s_RegEntryPool.Allocate(&slot));
+        auto entryRw = reinterpret_cast<RegEntry*>(slot.m_Rw);
+
+        /* Reserve the trampoline up front, the entry has to be complete before the hook can reach it. */
+        auto trampoline = AllocateTrampoline();
+
+        auto& code = entryRw->m_Code;
+        size_t index = 0;
+        auto forEachSaved = [saved](auto&& func) {
+            u16 slotIndex = 0;
+            for(uchar i = 0; i < 31; i++) {
+                if(saved & (1u << i))
+                    func(reg::Register(reg::RegisterKind::X, i), slotIndex++);
+            }
+        };
+
+        /* Back up the captured registers, they double as the context passed to the callback. */
+        code[index++] = inst::SubImmediate(reg::SP, reg::SP, frameSize);
+        forEachSaved([&](reg::Register r, u16 slotIndex) {
+            code[index++] = inst::StrRegisterImmediate(r, reg::SP, slotIndex);
+        });
+
+        /* Call the callback with the context, through IP0 as it's free to clobber anyways. */
+        code[index++] = inst::AddImmediate(reg::X0, reg::SP, 0);
+        const size_t literalLoadIndex = index++;
+        code[index++] = inst::BranchLinkRegister(reg::X16);
+
+        /* Restore the captured registers, picking up any changes the callback made. */
+        forEachSaved([&](reg::Register r, u16 slotIndex) {
+            code[index++] = inst::LdrRegisterImmediate(r, reg::SP, slotIndex);
+        });
+        code[index++] = inst::AddImmediate(reg::SP, reg::SP, frameSize);
+
+        /* Branch to trampoline. Pool chunks can be mapped anywhere, so go through IP1 when it's out of reach, like HookFuncImpl does. */
+        const s64 trampolineOffset = s64(trampoline) - s64(slot.m_Rx + index * sizeof(armv8::InstType));
+        const bool farTrampoline = !inst::Branch::IsInRange(trampolineOffset);
+        size_t trampolineLoadIndex = 0;
+        if(farTrampoline) {
+            trampolineLoadIndex = index++;
+            code[index++] = inst::BranchRegister(reg::X17);
+        } else {
+            code[index++] = inst::Branch(trampolineOffset);
+        }
+
+        /* The literals have to be 8-byte aligned. */
+        if(index % 2 != 0)
+            code[index++] = inst::Nop();
+        code[literalLoadIndex] = inst::LdrLiteral(reg::X16, (index - literalLoadIndex) * sizeof(armv8::InstType));
+        std::memcpy(static_cast<void*>(&code[index]), &callback, sizeof(callback));
+        index += sizeof(callback) / sizeof(armv8::InstType);
+        if(farTrampoline) {
+            code[trampolineLoadIndex] = inst::LdrLiteral(reg::X17, (index - trampolineLoadIndex) * sizeof(armv8::InstType));
+            std::memcpy(static_cast<void*>(&code[index]), &trampoline, sizeof(trampoline));
+            index += sizeof(trampoline) / sizeof(armv8::InstType);
+        }
+        EXL_ASSERT(index <= code.size());
+
+        entryRw->m_Trampoline = trampoline;
+        entryRw->m_Rw = slot.m_Rw;
+
+        /* Flush caches to have the entry's RX view be consistent. */
+        FlushCode(slot.m_Rx, index * sizeof(armv8::InstType));
+
+        /* Finally, hook to call into the entry. The trampoline is filled in before the hooked site is patched. */
+        HookWithTrampoline(hook, slot.m_Rx, trampoline);
+
+        return slot.m_Rx;
+    }
+
+    void UnhookInlineRegs(uintptr_t entry) {
+        EXL_ABORT_UNLESS(entry != 0);
+
+        auto entryRx = reinterpret_cast<const RegEntry*>(entry);
+        auto entryRw = reinterpret_cast<RegEntry*>(entryRx->m_Rw);
+        EXL_ABORT_UNLESS(entryRx->m_Trampoline != 0, "Inline hook was already uninstalled!");
+
+        /* Restore the hooked instructions first, nothing can reach the entry after that. */
+        Unhook(entryRx->m_Trampoline);
+
+        entryRw->m_Trampoline = 0;
+        s_RegEntryPool.Release({ entry, entryRx->m_Rw });
+    }
+}
\ No newline at end of file
@@ -18,7 +18,7 @@ namespace exl::hook::impl {
         static ALWAYS_INLINE void InstallAtOffset(ptrdiff_t address) {
             _HOOK_STATIC_CALLBACK_ASSERT();
 
-            hook::Hook(util::modules::GetTargetStart() + address, Derived::Callback);
+            hook::Hook(util::modules::GetTargetStart() + address, GetCallback<Derived>());
         }
 
         template<typename T>
@@ -28,13 +28,13 @@ namespace exl::hook::impl {
             using Traits = util::FuncPtrTraits<T>;
             static_assert(std::is_same_v<typename Traits::CPtr, CallbackFuncPtr<>>, "Argument pointer type must match callback type!");
 
-            hook::Hook(ptr, Derived::Callback);
+            hook::Hook(ptr, GetCallback<Derived>());
         }
 
         static ALWAYS_INLINE void InstallAtPtr(uintptr_t ptr) {
             _HOOK_STATIC_CALLBACK_ASSERT();
             
-            hook::Hook(ptr, Derived::Callback);
+            hook::Hook(ptr, GetCallback<Derived>());
         }
     };
 }
\ No newline at end of file
@@ -0,0 +1,56 @@
+#include "stats.hpp"
+
+#include <lib/log/logger_mgr.hpp>
+#include <program/loggers.hpp>
+
+namespace exl::hook {
+
+    namespace {
+        constinit std::atomic<HookStats*> s_Head = nullptr;
+    }
+
+    namespace impl {
+        void RegisterStats(HookStats& stats) {
+            if(stats.m_Registered.exchange(true, std::memory_order_relaxed))
+                return;
+
+            /* Lock-free push, entries are never removed so readers only need the head. */
+            HookStats* head = s_Head.load(std::memory_order_relaxed);
+            do {
+                stats.m_Next = head;
+            } while(!s_Head.compare_exchange_weak(head, &stats, std::memory_order_release, std::memory_order_relaxed));
+        }
+    }
+
+    HookStats* GetHookStatsHead() {
+        return s_Head.load(std::memory_order_acquire);
+    }
+
+    u64 HookTicksToMicroseconds(u64 ticks) {
+        return ticks * 1000000 / impl::GetSystemTickFrequency();
+    }
+
+    void ResetHookStats() {
+        /* Only the counters are reset, hooks stay linked. */
+        for(HookStats* stats = GetHookStatsHead(); stats != nullptr; stats = stats->m_Next) {
+            stats->m_CallCount.store(0, std::memory_order_relaxed);
+            stats->m_CallbackTicks.store(0, std::memory_order_relaxed);
+            stats->m_OrigCallCount.store(0, std::memory_order_relaxed);
+            stats->m_OrigTicks.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void DumpHookStats() {
+        ForEachHookStats([](const HookStats& stats) {
+            const u64 callCount = stats.m_CallCount.load(std::memory_order_relaxed);
+            const u64 callbackUs = HookTicksToMicroseconds(stats.m_CallbackTicks.load(std::memory_order_relaxed));
+            const u64 origCallCount = stats.m_OrigCallCount.load(std::memory_order_relaxed);
+            const u64 origUs = HookTicksToMicroseconds(stats.m_OrigTicks.load(std::memory_order_relaxed));
+
+            Logging.Log("%.*s: %lu calls, %lu us in callback (%lu us avg), %lu orig calls, %lu us in orig",
+                static_cast<int>(stats.m_Name.size()), stats.m_Name.data(),
+                callCount, callbackUs, callCount != 0 ? callbackUs / callCount : 0,
+                origCallCount, origUs);
+        });
+    }
+}
\ No newline at end of file
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <atomic>
+#include <string_view>
+#include <utility>
+#include <common.hpp>
+
+#include <program/setting.hpp>
+
+namespace exl::hook {
+
+    /*
+        Call counts and time spent in a HOOK_DEFINE_* hook, only collected with setting::EnableHookStats.
+        The callback time includes any calls to Orig made from it, which are also tracked separately.
+    */
+    struct HookStats {
+        std::string_view m_Name;
+        std::atomic<u64> m_CallCount;
+        std::atomic<u64> m_CallbackTicks;
+        std::atomic<u64> m_OrigCallCount;
+        std::atomic<u64> m_OrigTicks;
+
+        /* Hooks are linked in when first installed and never unlinked, as their stats are static. */
+        std::atomic<bool> m_Registered;
+        HookStats* m_Next;
+    };
+
+    namespace impl {
+        /* Reads the counter directly, a syscall per measurement would skew short hooks. */
+        ALWAYS_INLINE u64 GetSystemTick() {
+            u64 tick;
+            __asm__ __volatile__("mrs %x[data], cntpct_el0" : [data] "=r" (tick));
+            return tick;
+        }
+
+        ALWAYS_INLINE u64 GetSystemTickFrequency() {
+            u64 frequency;
+            __asm__ ("mrs %x[data], cntfrq_el0" : [data] "=r" (frequency));
+            return frequency;
+        }
+
+        class ScopedTicks {
+            NON_COPYABLE(ScopedTicks);
+            NON_MOVEABLE(ScopedTicks);
+
+            std::atomic<u64>& m_Ticks;
+            u64 m_Start;
+
+            public:
+            ALWAYS_INLINE ScopedTicks(std::atomic<u64>& ticks) : m_Ticks(ticks), m_Start(GetSystemTick()) {}
+            ALWAYS_INLINE ~ScopedTicks() {
+                m_Ticks.fetch_add(GetSystemTick() - m_Start, std::memory_order_relaxed);
+            }
+        };
+
+        /* There is no RTTI, so the name is taken from the signature GCC generates for this function. */
+        template<typename T>
+        consteval std::string_view GetTypeName() {
+            constexpr std::string_view signature = __PRETTY_FUNCTION__;
+            constexpr std::string_view prefix = "T = ";
+            constexpr size_t start = signature.find(prefix) + prefix.size();
+            constexpr size_t end = signature.find_first_of(";]", start);
+            return signature.substr(start, end - start);
+        }
+
+        template<typename Derived>
+        ALWAYS_INLINE HookStats& GetStats() {
+            static constinit HookStats s_Stats {
+                .m_Name = GetTypeName<Derived>(),
+            };
+
+            return s_Stats;
+        }
+
+        void RegisterStats(HookStats& stats);
+
+        template<typename Derived, typename CallbackFuncPtr = decltype(&Derived::Callback)>
+        struct StatsCallback;
+
+        /* Installed in place of Derived::Callback to account for every call to it. */
+        template<typename Derived, typename R, typename... Args>
+        struct StatsCallback<Derived, R (*)(Args...)> {
+            static R Callback(Args... args) {
+                HookStats& stats = GetStats<Derived>();
+                stats.m_CallCount.fetch_add(1, std::memory_order_relaxed);
+
+                ScopedTicks ticks(stats.m_CallbackTicks);
+                return Derived::Callback(std::forward<Args>(args)...);
+            }
+        };
+
+        /* What the HOOK_DEFINE_* hooks install as their callback. */
+        template<typename Derived>
+        ALWAYS_INLINE auto GetCallback() {
+            if constexpr(setting::EnableHookStats) {
+                RegisterStats(GetStats<Derived>());
+                return &StatsCallback<Derived>::Callback;
+            } else {
+                return &Derived::Callback;
+            }
+        }
+
+        /* Wraps calls to the original function of trampoline hooks. */
+        template<typename Derived>
+        ALWAYS_INLINE decltype(auto) CallOrig(auto func, auto&&... args) {
+            if constexpr(setting::EnableHookStats) {
+                HookStats& stats = GetStats<Derived>();
+                stats.m_OrigCallCount.fetch_add(1, std::memory_order_relaxed);
+
+                ScopedTicks ticks(stats.m_OrigTicks);
+                return func(std::forward<decltype(args)>(args)...);
+            } else {
+                return func(std::forward<decltype(args)>(args)...);
+            }
+        }
+    }
+
+    HookStats* GetHookStatsHead();
+
+    /* Calls func with the stats of every hook installed so far. */
+    template<typename Func>
+    void ForEachHookStats(Func func) {
+        for(HookStats* stats = GetHookStatsHead(); stats != nullptr; stats = stats->m_Next)
+            func(static_cast<const HookStats&>(*stats));
+    }
+
+    u64 HookTicksToMicroseconds(u64 ticks);
+
+    void ResetHookStats();
+
+    /* Logs a line for every hook installed so far. */
+    void DumpHookStats();
+}
\ No newline at end of file
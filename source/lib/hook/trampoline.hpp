@@ -3,6 +3,7 @@
 #include "base.hpp"
 #include "util/func_ptrs.hpp"
 #include <functional>
+#include <utility>
 
 #define HOOK_DEFINE_TRAMPOLINE(name)                        \
 struct name : public ::exl::hook::impl::TrampolineHook<name>
@@ -28,13 +29,13 @@ namespace exl::hook::impl {
         static ALWAYS_INLINE decltype(auto) Orig(Args &&... args) {
             _HOOK_STATIC_CALLBACK_ASSERT();
 
-            return OrigRef()(std::forward<Args>(args)...);
+            return CallOrig<Derived>(OrigRef(), std::forward<Args>(args)...);
         }
 
         static ALWAYS_INLINE void InstallAtOffset(ptrdiff_t address) {
             _HOOK_STATIC_CALLBACK_ASSERT();
 
-            OrigRef() = hook::Hook(util::modules::GetTargetStart() + address, Derived::Callback, true);
+            OrigRef() = hook::Hook(util::modules::GetTargetStart() + address, GetCallback<Derived>(), true);
         }
 
         template<typename T>
@@ -44,13 +45,19 @@ namespace exl::hook::impl {
             using Traits = util::FuncPtrTraits<T>;
             static_assert(std::is_same_v<typename Traits::CPtr, CallbackFuncPtr<>>, "Argument pointer type must match callback type!");
 
-            OrigRef() = hook::Hook(ptr, Derived::Callback, true);
+            OrigRef() = hook::Hook(ptr, GetCallback<Derived>(), true);
         }
 
         static ALWAYS_INLINE void InstallAtPtr(uintptr_t ptr) {
             _HOOK_STATIC_CALLBACK_ASSERT();
             
-            OrigRef() = hook::Hook(ptr, Derived::Callback, true);
+            OrigRef() = hook::Hook(ptr, GetCallback<Derived>(), true);
+        }
+
+        static ALWAYS_INLINE void Uninstall() {
+            _HOOK_STATIC_CALLBACK_ASSERT();
+
+            hook::Unhook(std::exchange(OrigRef(), nullptr));
         }
     };
 
@@ -16,14 +16,11 @@ extern "C" {
 
     #ifdef EXL_USE_FAKEHEAP
 
-    char __fake_heap[exl::setting::HeapSize];
+    alignas(exl::alloc::Tlsf::Alignment) char __fake_heap[exl::setting::HeapSize];
 
     void __init_heap() {
-        extern char * fake_heap_start;
-        extern char * fake_heap_end;
-
-        fake_heap_start = __fake_heap;
-        fake_heap_end   = __fake_heap + exl::setting::HeapSize;
+        /* Backed by a TLSF allocator rather than newlib's sbrk-based malloc for bounded allocation latency. */
+        exl::alloc::impl::InitializeFakeHeap(__fake_heap, exl::setting::HeapSize);
     }
     
     #endif
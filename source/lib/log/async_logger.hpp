@@ -0,0 +1,237 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstring>
+#include <string_view>
+#include <common.hpp>
+
+#include <nn/os.hpp>
+#include <nn/util/util_sprintf.hpp>
+
+#include <program/setting.hpp>
+
+#include "deferred.hpp"
+#include "ilogger.hpp"
+
+namespace exl::log {
+
+    /*
+        Bounded lock-free multi-producer single-consumer queue of fixed size records.
+        Each slot carries a turn counter: producers may write a slot on even turns and the consumer may read it on odd turns,
+        which lets a zero initialized queue be valid without a constructor.
+    */
+    template<size_t SlotCount, size_t SlotSize>
+    class LogRingBuffer {
+        static_assert(std::has_single_bit(SlotCount), "Slot count must be a power of two.");
+
+        struct Slot {
+            std::atomic<size_t> m_Turn;
+            size_t m_Length;
+            char m_Data[SlotSize];
+        };
+
+        Slot m_Slots[SlotCount] {};
+        alignas(0x40) std::atomic<size_t> m_WritePosition {};
+        alignas(0x40) size_t m_ReadPosition {};
+        std::atomic<size_t> m_DropCount {};
+
+        static constexpr size_t GetLap(size_t position) { return position / SlotCount; }
+
+        public:
+        /* Claims a slot and lets writer fill in exactly size bytes of it. */
+        bool TryPush(size_t size, auto&& writer) {
+            if (size > SlotSize) {
+                m_DropCount.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+
+            size_t position = m_WritePosition.load(std::memory_order_relaxed);
+            while (true) {
+                Slot& slot = m_Slots[position % SlotCount];
+                const size_t writeTurn = GetLap(position) * 2;
+                const size_t turn = slot.m_Turn.load(std::memory_order_acquire);
+
+                if (turn == writeTurn) {
+                    if (m_WritePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                        writer(slot.m_Data);
+                        slot.m_Length = size;
+                        slot.m_Turn.store(writeTurn + 1, std::memory_order_release);
+                        return true;
+                    }
+                } else if (turn < writeTurn) {
+                    /* The consumer hasn't released this slot from the previous lap, so the queue is full. */
+                    m_DropCount.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                } else {
+                    /* Another producer claimed this position first. */
+                    position = m_WritePosition.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        /* Must only be called from a single consumer. */
+        size_t Drain(auto&& func) {
+            size_t count = 0;
+            while (true) {
+                Slot& slot = m_Slots[m_ReadPosition % SlotCount];
+                const size_t readTurn = GetLap(m_ReadPosition) * 2 + 1;
+                if (slot.m_Turn.load(std::memory_order_acquire) != readTurn)
+                    break;
+
+                func(std::string_view { slot.m_Data, slot.m_Length });
+                slot.m_Turn.store(readTurn + 1, std::memory_order_release);
+                m_ReadPosition++;
+                count++;
+            }
+            return count;
+        }
+
+        size_t GetDropCount() const { return m_DropCount.load(std::memory_order_relaxed); }
+    };
+
+    /*
+        Wraps a sink so that LogRaw only copies the record into a ring buffer, and a low priority thread forwards records to the sink.
+        Records are forwarded synchronously until StartAsync is called, as the thread can only be created once nnSdk is usable.
+        Deferred records hold raw arguments and are only formatted on the drain thread.
+    */
+    template<typename Sink>
+    class AsyncLogger : public ILogger {
+        /* Every record starts with a header, text records have no formatter. */
+        struct RecordHeader {
+            impl::DeferredFormatter m_Formatter;
+            const char* m_Format;
+        };
+
+        using QueueType = LogRingBuffer<setting::AsyncLogQueueCount, sizeof(RecordHeader) + setting::LogBufferSize>;
+
+        Sink m_Sink {};
+        QueueType m_Queue {};
+        nn::os::ThreadType m_Thread {};
+        std::atomic<bool> m_Started {};
+        std::atomic<bool> m_FlushRequested {};
+        size_t m_ReportedDropCount {};
+        std::atomic<size_t> m_TruncateCount {};
+        alignas(nn::os::ThreadStackAlignment) u8 m_ThreadStack[setting::AsyncLogThreadStackSize] {};
+
+        void DrainToSink() {
+            m_Queue.Drain([this](std::string_view record) {
+                RecordHeader header;
+                std::memcpy(&header, record.data(), sizeof(header));
+                const std::string_view payload = record.substr(sizeof(header));
+
+                if (header.m_Formatter == nullptr) {
+                    m_Sink.LogRaw(payload);
+                    return;
+                }
+
+                char buffer[setting::LogBufferSize];
+                size_t length = header.m_Formatter(buffer, sizeof(buffer), header.m_Format, reinterpret_cast<const u8*>(payload.data()));
+                length = std::min(length, sizeof(buffer) - 1);
+                m_Sink.LogRaw(std::string_view { buffer, length });
+            });
+
+            /* Let the sink know records were lost, as it's otherwise invisible in the output. */
+            const size_t dropCount = m_Queue.GetDropCount();
+            if (dropCount != m_ReportedDropCount) {
+                char buffer[0x40];
+                const size_t length = nn::util::SNPrintf(buffer, sizeof(buffer), "[%lu log records dropped]", dropCount - m_ReportedDropCount);
+                m_Sink.LogRaw(std::string_view { buffer, std::min(length, sizeof(buffer) - 1) });
+                m_ReportedDropCount = dropCount;
+            }
+        }
+
+        static void ThreadMain(void* arg) {
+            auto* self = static_cast<AsyncLogger*>(arg);
+            while (true) {
+                self->DrainToSink();
+
+                /* Gives sinks a chance to do time based work, like flushing buffers. */
+                if constexpr (requires { self->m_Sink.Update(); })
+                    self->m_Sink.Update();
+
+                if (self->m_FlushRequested.load(std::memory_order_acquire)) {
+                    if constexpr (requires { self->m_Sink.Flush(); })
+                        self->m_Sink.Flush();
+                    self->m_FlushRequested.store(false, std::memory_order_release);
+                }
+
+                nn::os::SleepThread(nn::TimeSpan::FromMilliSeconds(setting::AsyncLogDrainIntervalMs));
+            }
+        }
+
+        public:
+        /* Declaring LogRaw as final allows the compiler to properly optimize. */
+        virtual void LogRaw(std::string_view data) final {
+            if (!m_Started.load(std::memory_order_acquire)) {
+                m_Sink.LogRaw(data);
+                return;
+            }
+
+            if (data.size() > setting::LogBufferSize) {
+                data = data.substr(0, setting::LogBufferSize);
+                m_TruncateCount.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            m_Queue.TryPush(sizeof(RecordHeader) + data.size(), [&](char* slot) {
+                const RecordHeader header = {};
+                std::memcpy(slot, &header, sizeof(header));
+                std::memcpy(slot + sizeof(header), data.data(), data.size());
+            });
+        }
+
+        /* Queues the format string and raw arguments, formatting is done by the drain thread. */
+        template<typename... Args>
+        void LogDeferred(const char* fmt, const Args&... args) {
+            const size_t argsSize = impl::GetDeferredArgsSize(args...);
+
+            /* Before the thread is up, or if the arguments don't fit in a slot, fall back to formatting on the caller. */
+            if (!m_Started.load(std::memory_order_acquire) || argsSize > setting::LogBufferSize) {
+                char buffer[setting::LogBufferSize];
+                size_t length = nn::util::SNPrintf(buffer, sizeof(buffer), fmt, args...);
+                length = std::min(length, sizeof(buffer) - 1);
+                LogRaw(std::string_view { buffer, length });
+                return;
+            }
+
+            const size_t size = sizeof(RecordHeader) + argsSize;
+            m_Queue.TryPush(size, [&](char* slot) {
+                const RecordHeader header = { impl::GetDeferredFormatter<Args...>(), fmt };
+                std::memcpy(slot, &header, sizeof(header));
+                impl::WriteDeferredArgs(reinterpret_cast<u8*>(slot + sizeof(header)), args...);
+            });
+        }
+
+        void StartAsync() {
+            if (m_Started.load(std::memory_order_relaxed))
+                return;
+
+            R_ABORT_UNLESS(nn::os::CreateThread(&m_Thread, ThreadMain, this, m_ThreadStack, sizeof(m_ThreadStack), setting::AsyncLogThreadPriority));
+            nn::os::SetThreadNamePointer(&m_Thread, "exl::log::AsyncLogger");
+            m_Started.store(true, std::memory_order_release);
+            nn::os::StartThread(&m_Thread);
+        }
+
+        /* Waits (for a bounded amount of time) until every record queued so far has been handed to the sink. */
+        void Flush() {
+            /* Only the drain thread may consume the queue, so anyone else asks it to flush on their behalf. */
+            if (!m_Started.load(std::memory_order_acquire) || nn::os::GetCurrentThread() == &m_Thread) {
+                if (m_Started.load(std::memory_order_relaxed))
+                    DrainToSink();
+                if constexpr (requires { m_Sink.Flush(); })
+                    m_Sink.Flush();
+                return;
+            }
+
+            m_FlushRequested.store(true, std::memory_order_release);
+            for (s32 i = 0; i < setting::AsyncLogFlushWaitCount && m_FlushRequested.load(std::memory_order_acquire); i++)
+                nn::os::SleepThread(nn::TimeSpan::FromMilliSeconds(setting::AsyncLogDrainIntervalMs));
+        }
+
+        size_t GetDropCount() const { return m_Queue.GetDropCount(); }
+        size_t GetTruncateCount() const { return m_TruncateCount.load(std::memory_order_relaxed); }
+
+        Sink& GetSink() { return m_Sink; }
+    };
+}
\ No newline at end of file
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstring>
+#include <tuple>
+#include <type_traits>
+#include <common.hpp>
+
+#include <nn/util/util_sprintf.hpp>
+
+#include <program/setting.hpp>
+
+namespace exl::log {
+
+    /*
+        Deferred records store the format string pointer and the raw argument values instead of formatted text.
+        The argument types are captured at compile time in a formatter instantiated per call signature,
+        so the record can be decoded and formatted later by whoever drains it.
+    */
+    namespace impl {
+        static_assert(setting::LogBufferSize <= UINT16_MAX, "");
+
+        using DeferredFormatter = size_t (*)(char* buffer, size_t bufferSize, const char* fmt, const u8* args);
+
+        template<typename T>
+        concept DeferredString = std::is_same_v<std::decay_t<T>, const char*> || std::is_same_v<std::decay_t<T>, char*>;
+
+        template<typename T>
+        concept DeferredValue = !DeferredString<T> && (std::is_arithmetic_v<std::decay_t<T>> || std::is_enum_v<std::decay_t<T>> || std::is_pointer_v<std::decay_t<T>>);
+
+        template<typename T>
+        concept DeferredArgument = DeferredString<T> || DeferredValue<T>;
+
+        /* Strings are copied into the record, as the pointer may not outlive the call. */
+        template<typename T>
+        using DeferredDecodedType = std::conditional_t<DeferredString<T>, const char*, std::decay_t<T>>;
+
+        /* Strings longer than a formatted record could never be printed in full, so they are cut off there. */
+        ALWAYS_INLINE u16 GetDeferredStringLength(const char* string) {
+            if (string == nullptr)
+                return 0;
+
+            u16 length = 0;
+            while (length < setting::LogBufferSize && string[length] != '\0')
+                length++;
+            return length;
+        }
+
+        template<DeferredArgument T>
+        ALWAYS_INLINE size_t GetDeferredSize(const T& value) {
+            if constexpr (DeferredString<T>) {
+                return sizeof(u16) + GetDeferredStringLength(value) + 1;
+            } else {
+                return sizeof(std::decay_t<T>);
+            }
+        }
+
+        template<DeferredArgument T>
+        ALWAYS_INLINE void WriteDeferred(u8*& cursor, const T& value) {
+            if constexpr (DeferredString<T>) {
+                const u16 length = GetDeferredStringLength(value);
+                std::memcpy(cursor, &length, sizeof(length));
+                if (length != 0)
+                    std::memcpy(cursor + sizeof(length), value, length);
+                cursor[sizeof(length) + length] = '\0';
+                cursor += sizeof(length) + length + 1;
+            } else {
+                const std::decay_t<T> decayed = value;
+                std::memcpy(cursor, &decayed, sizeof(decayed));
+                cursor += sizeof(decayed);
+            }
+        }
+
+        template<DeferredArgument T>
+        ALWAYS_INLINE DeferredDecodedType<T> ReadDeferred(const u8*& cursor) {
+            if constexpr (DeferredString<T>) {
+                u16 length;
+                std::memcpy(&length, cursor, sizeof(length));
+                const char* string = reinterpret_cast<const char*>(cursor + sizeof(length));
+                cursor += sizeof(length) + length + 1;
+                return string;
+            } else {
+                std::decay_t<T> value;
+                std::memcpy(&value, cursor, sizeof(value));
+                cursor += sizeof(value);
+                return value;
+            }
+        }
+
+        template<typename... Args>
+        size_t GetDeferredArgsSize(const Args&... args) {
+            return (static_cast<size_t>(0) + ... + GetDeferredSize(args));
+        }
+
+        template<typename... Args>
+        void WriteDeferredArgs(u8* cursor, const Args&... args) {
+            (WriteDeferred(cursor, args), ...);
+        }
+
+        template<typename... Args>
+        size_t FormatDeferred(char* buffer, size_t bufferSize, const char* fmt, const u8* args) {
+            /* Braced initialization guarantees the arguments are read in order. */
+            const std::tuple<DeferredDecodedType<Args>...> values { ReadDeferred<Args>(args)... };
+            return std::apply([&](const auto&... unpacked) {
+                return nn::util::SNPrintf(buffer, bufferSize, fmt, unpacked...);
+            }, values);
+        }
+
+        template<typename... Args>
+        constexpr DeferredFormatter GetDeferredFormatter() {
+            return &FormatDeferred<std::remove_cvref_t<Args>...>;
+        }
+
+        template<typename Logger, typename... Args>
+        concept DeferredLogger = requires (Logger& logger, const char* fmt, const Args&... args) {
+            logger.LogDeferred(fmt, args...);
+        };
+    }
+}
\ No newline at end of file
@@ -0,0 +1,110 @@
+#include "file_logger.hpp"
+
+#include <cstring>
+
+#include <nn/os/impl/os_tick_manager_impl.os.horizon.hpp>
+#include <nn/util/util_sprintf.hpp>
+
+namespace exl::log {
+
+    namespace {
+        constexpr u64 FlushIntervalTicks = nn::os::detail::TickManagerImpl::GetTickFrequency() * setting::FileLogFlushIntervalMs / 1000;
+
+        void GetRotatedPath(char* buffer, size_t bufferSize, s32 index) {
+            if (index == 0)
+                nn::util::SNPrintf(buffer, bufferSize, "%s", setting::FileLogPath);
+            else
+                nn::util::SNPrintf(buffer, bufferSize, "%s.%d", setting::FileLogPath, index);
+        }
+    }
+
+    void FileLogger::LogRaw(std::string_view string) {
+        /* Records are stored newline terminated. */
+        const size_t required = string.size() + 1;
+        if (m_BufferSize + required > sizeof(m_Buffer))
+            Flush();
+
+        /* Either I/O isn't possible yet or the write failed, there's nowhere to put this. */
+        if (m_BufferSize + required > sizeof(m_Buffer)) {
+            m_DropCount++;
+            return;
+        }
+
+        std::memcpy(m_Buffer + m_BufferSize, string.data(), string.size());
+        m_BufferSize += string.size();
+        m_Buffer[m_BufferSize++] = '\n';
+    }
+
+    void FileLogger::Update() {
+        m_IsIoEnabled = true;
+
+        if (m_BufferSize != 0 && svcGetSystemTick() - m_LastFlushTick >= FlushIntervalTicks)
+            Flush();
+    }
+
+    void FileLogger::Flush() {
+        if (!m_IsIoEnabled || m_BufferSize == 0)
+            return;
+
+        m_LastFlushTick = svcGetSystemTick();
+
+        if (m_FileSize != 0 && m_FileSize + static_cast<s64>(m_BufferSize) > setting::FileLogRotateSize)
+            Rotate();
+
+        if (!m_IsOpen && !Open())
+            return;
+
+        const auto option = nn::fs::WriteOption::CreateOption(nn::fs::WriteOptionFlag_Flush);
+        if (nn::fs::WriteFile(m_Handle, m_FileSize, m_Buffer, m_BufferSize, option) != 0) {
+            /* Keep the buffer around and retry on the next flush. */
+            Close();
+            return;
+        }
+
+        m_FileSize += m_BufferSize;
+        m_BufferSize = 0;
+    }
+
+    bool FileLogger::Open() {
+        constexpr int Mode = nn::fs::OpenMode_Write | nn::fs::OpenMode_Append;
+        if (nn::fs::OpenFile(&m_Handle, setting::FileLogPath, Mode) != 0) {
+            if (nn::fs::CreateFile(setting::FileLogPath, 0) != 0)
+                return false;
+            if (nn::fs::OpenFile(&m_Handle, setting::FileLogPath, Mode) != 0)
+                return false;
+        }
+
+        long size = 0;
+        if (nn::fs::GetFileSize(&size, m_Handle) != 0) {
+            nn::fs::CloseFile(m_Handle);
+            return false;
+        }
+
+        m_FileSize = size;
+        m_IsOpen = true;
+        return true;
+    }
+
+    void FileLogger::Close() {
+        if (m_IsOpen)
+            nn::fs::CloseFile(m_Handle);
+        m_IsOpen = false;
+    }
+
+    void FileLogger::Rotate() {
+        Close();
+
+        /* Shift log.txt -> log.txt.1 -> log.txt.2 ..., dropping the oldest. */
+        char from[0x100];
+        char to[0x100];
+        GetRotatedPath(to, sizeof(to), setting::FileLogRotateCount);
+        nn::fs::DeleteFile(to);
+        for (s32 i = setting::FileLogRotateCount; i > 0; i--) {
+            GetRotatedPath(from, sizeof(from), i - 1);
+            GetRotatedPath(to, sizeof(to), i);
+            nn::fs::RenameFile(from, to);
+        }
+
+        m_FileSize = 0;
+    }
+}
\ No newline at end of file
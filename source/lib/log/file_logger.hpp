@@ -0,0 +1,40 @@
+#pragma once
+
+#include "ilogger.hpp"
+
+#include <common.hpp>
+#include <nn/fs.hpp>
+
+#include <program/setting.hpp>
+
+namespace exl::log {
+
+    /*
+        Appends records to a file through an in-memory buffer, only writing once the buffer fills up or the flush interval elapses.
+        No I/O is performed until Update is first called, as nnSdk may not be usable yet. Not thread safe, wrap it in an AsyncLogger.
+    */
+    struct FileLogger : public ILogger {
+        /* Declaring LogRaw as final allows the compiler to properly optimize. */
+        virtual void LogRaw(std::string_view string) final;
+
+        /* Flushes if the flush interval has elapsed. Called periodically by AsyncLogger's drain thread. */
+        void Update();
+        void Flush();
+
+        size_t GetDropCount() const { return m_DropCount; }
+
+        private:
+        char m_Buffer[setting::FileLogBufferSize] {};
+        size_t m_BufferSize = 0;
+        nn::fs::FileHandle m_Handle {};
+        bool m_IsOpen = false;
+        bool m_IsIoEnabled = false;
+        s64 m_FileSize = 0;
+        u64 m_LastFlushTick = 0;
+        size_t m_DropCount = 0;
+
+        bool Open();
+        void Close();
+        void Rotate();
+    };
+}
\ No newline at end of file
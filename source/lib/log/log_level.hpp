@@ -0,0 +1,14 @@
+#pragma once
+
+namespace exl::log {
+
+    enum class Level {
+        Trace,
+        Debug,
+        Info,
+        Warning,
+        Error,
+        /* Disables all leveled logging. */
+        None,
+    };
+}
\ No newline at end of file
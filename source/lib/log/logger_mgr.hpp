@@ -12,6 +12,9 @@
 
 #include <program/setting.hpp>
 
+#include "deferred.hpp"
+#include "log_level.hpp"
+
 #define EXL_LOG_PREFIX "[" EXL_MODULE_NAME "|exlaunch] "
 
 namespace exl::log {
@@ -51,6 +54,22 @@ namespace exl::log {
             return std::get<T>(m_Loggers);
         }
 
+        /* Starts the drain threads of any asynchronous loggers. Must be called once nnSdk is usable. */
+        void StartAsync() {
+            this->ForEachLogger([](auto& logger) {
+                if constexpr (requires { logger.StartAsync(); })
+                    logger.StartAsync();
+            });
+        }
+
+        /* Hands any buffered records to their sinks, for loggers that buffer. */
+        void Flush() {
+            this->ForEachLogger([](auto& logger) {
+                if constexpr (requires { logger.Flush(); })
+                    logger.Flush();
+            });
+        }
+
         ALWAYS_INLINE void Log(const char* string) { LogImpl(string); }
         ALWAYS_INLINE void Log(std::string_view string) { LogImpl(string); }
 
@@ -64,6 +83,44 @@ namespace exl::log {
             LogImpl(std::string_view { buffer, length });
         }
 
+        /* Leveled variant, calls below setting::LogLevel are compiled out along with their arguments. */
+        template<Level L, typename... Args>
+        ALWAYS_INLINE void Log(const char* fmt, Args&&... args) {
+            if constexpr (L >= setting::LogLevel)
+                Log(fmt, std::forward<Args>(args)...);
+        }
+
+        /*
+            Loggers that support it only capture the format string and arguments, formatting happens later on their own thread.
+            The remaining loggers share a single eagerly formatted copy.
+        */
+        template<typename... Args>
+        ALWAYS_INLINE void LogDeferred(const char* fmt, const Args&... args) {
+            static_assert((impl::DeferredArgument<Args> && ...), "Deferred arguments must be arithmetic, enums, pointers or C strings.");
+
+            constexpr bool NeedsFormat = (!impl::DeferredLogger<Types, Args...> || ...);
+
+            char buffer[NeedsFormat ? setting::LogBufferSize : 1];
+            size_t length = 0;
+            if constexpr (NeedsFormat) {
+                length = nn::util::SNPrintf(buffer, sizeof(buffer), fmt, args...);
+                length = std::min(length, sizeof(buffer)-1);
+            }
+
+            this->ForEachLogger([&](auto& logger) {
+                if constexpr (impl::DeferredLogger<std::remove_cvref_t<decltype(logger)>, Args...>)
+                    logger.LogDeferred(fmt, args...);
+                else
+                    logger.LogRaw(std::string_view { buffer, length });
+            });
+        }
+
+        template<Level L, typename... Args>
+        ALWAYS_INLINE void LogDeferred(const char* fmt, const Args&... args) {
+            if constexpr (L >= setting::LogLevel)
+                LogDeferred(fmt, args...);
+        }
+
         template<typename... Args>
         ALWAYS_INLINE void VLog(const char* fmt, std::va_list vl) {
             char buffer[setting::LogBufferSize];
@@ -4,8 +4,12 @@
 #include <lib/log/logger_mgr.hpp>
 #include <program/loggers.hpp>
 
+#include <mutex>
+
 #include <lib/reloc/reloc.hpp>
+#include <lib/util/sys/spin_lock.hpp>
 #include <program/offsets.hpp>
+#include <program/setting.hpp>
 
 namespace exl::reloc {
 
@@ -32,7 +36,104 @@ namespace exl::reloc {
             
             s_InitializeSucceeded = true;
             s_CachedLookup.m_Entries = s_UserTableSet.Get(version);
+            s_CachedLookup.m_Filter = s_UserTableSet.GetFilter(version);
             s_CachedLookup.Apply();
         }
     }
+
+    namespace {
+
+        /*
+            Names are keyed by both their Murmur3 and GNU hash, positive entries are confirmed against the symbol's own name.
+            Negative entries can't be, so a false miss would take two 32-bit hashes colliding at once.
+        */
+        struct SymbolCacheEntry {
+            u64 m_Key;
+            Elf_Sym* m_Symbol;
+            util::ModuleIndex m_Module;
+        };
+
+        /* A name is only ever stored within this many slots of where it hashes to. */
+        constexpr size_t SymbolCacheProbeCount = 8;
+
+        constinit util::SpinLock s_SymbolCacheLock;
+        constinit std::array<SymbolCacheEntry, setting::SymbolCacheSize> s_SymbolCache {};
+        constinit u32 s_SymbolCacheGeneration = 0;
+
+        Elf_Sym* FindSymbolUncached(const char* name, util::ModuleIndex* outModule) {
+            for(auto i = static_cast<int>(util::ModuleIndex::Start); i < static_cast<int>(util::ModuleIndex::End); i++) {
+                auto index = static_cast<util::ModuleIndex>(i);
+                /* Ignore non-existent modules. */
+                if(!util::HasModule(index))
+                    continue;
+
+                auto res = GetSymbol(index, name);
+                if(res != nullptr) {
+                    *outModule = index;
+                    return res;
+                }
+            }
+
+            return nullptr;
+        }
+
+        u64 GetSymbolCacheKey(const char* name) {
+            const u64 key = (static_cast<u64>(util::Murmur3::Compute(std::string_view(name))) << 32) | impl::GnuHash(name);
+            /* Zero marks an empty slot. */
+            return key != 0 ? key : 1;
+        }
+
+        /* Must be called with the lock held. Nothing cached against an older module layout can be trusted. */
+        void ValidateSymbolCache() {
+            if(s_SymbolCacheGeneration != util::GetModuleLayoutGeneration()) {
+                s_SymbolCache = {};
+                s_SymbolCacheGeneration = util::GetModuleLayoutGeneration();
+            }
+        }
+    }
+
+    Elf_Sym* GetSymbol(const char* name) {
+        const u64 key = GetSymbolCacheKey(name);
+        const size_t home = key & (s_SymbolCache.size() - 1);
+
+        {
+            std::scoped_lock lock(s_SymbolCacheLock);
+            ValidateSymbolCache();
+
+            for(size_t i = 0; i < SymbolCacheProbeCount; i++) {
+                const auto& entry = s_SymbolCache[(home + i) & (s_SymbolCache.size() - 1)];
+                if(entry.m_Key == 0)
+                    break;
+                if(entry.m_Key != key)
+                    continue;
+
+                if(entry.m_Symbol == nullptr)
+                    return nullptr;
+
+                const auto module = impl::GetModuleRuntime(entry.m_Module);
+                if(std::strcmp(name, module->dynstr + entry.m_Symbol->st_name) == 0)
+                    return entry.m_Symbol;
+            }
+        }
+
+        /* Resolve outside of the lock, the module tables may have to be parsed first. */
+        util::ModuleIndex module = util::ModuleIndex::End;
+        Elf_Sym* symbol = FindSymbolUncached(name, &module);
+
+        std::scoped_lock lock(s_SymbolCacheLock);
+        ValidateSymbolCache();
+
+        /* Take the first free slot, or evict the one the name hashes to if they're all taken. */
+        auto* slot = &s_SymbolCache[home];
+        for(size_t i = 0; i < SymbolCacheProbeCount; i++) {
+            auto& entry = s_SymbolCache[(home + i) & (s_SymbolCache.size() - 1)];
+            if(entry.m_Key == 0 || entry.m_Key == key) {
+                slot = &entry;
+                break;
+            }
+        }
+        *slot = { key, symbol, module };
+
+        return symbol;
+    }
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #include <cstdint>
 #include <algorithm>
+#include <array>
 #include <bit>
 #include <functional>
 #include <ranges>
@@ -54,6 +55,36 @@ namespace exl::reloc {
             }
             return h;
         }
+
+        /* Hash function used by DT_GNU_HASH. */
+        inline constexpr uint32_t GnuHash(const char *name) {
+            uint32_t h = 5381;
+
+            while (*name)
+                h = (h << 5) + h + static_cast<unsigned char>(*name++);
+            return h;
+        }
+
+        /* Parsed on first use, and again if the module layout changes. Modules without DT_GNU_HASH are left invalid and looked up through DT_HASH instead. */
+        inline const rtld::GnuHashTable& GetModuleGnuHash(util::ModuleIndex index) {
+            static constexpr size_t s_Count = static_cast<size_t>(util::ModuleIndex::End);
+            static constinit std::array<rtld::GnuHashTable, s_Count> s_Tables {};
+            static constinit std::array<bool, s_Count> s_Parsed {};
+            static constinit std::array<u32, s_Count> s_Generations {};
+
+            const auto i = static_cast<size_t>(index);
+            if(EXL_UNLIKELY(!s_Parsed[i] || s_Generations[i] != util::GetModuleLayoutGeneration())) {
+                const auto& info = util::GetModuleInfo(index);
+                s_Tables[i].Initialize(
+                    reinterpret_cast<char*>(info.m_Total.m_Start),
+                    const_cast<Elf_Dyn*>(info.m_Mod->GetDynamic())
+                );
+                s_Parsed[i] = true;
+                s_Generations[i] = util::GetModuleLayoutGeneration();
+            }
+
+            return s_Tables[i];
+        }
     }
 
 
@@ -62,6 +93,12 @@ namespace exl::reloc {
 
     inline Elf_Sym* GetSymbol(util::ModuleIndex index, const char* name) {
         auto module = impl::GetModuleRuntime(index);
+
+        /* The bloom filter lets the GNU table reject most misses without touching the chains. */
+        const auto& gnuHash = impl::GetModuleGnuHash(index);
+        if(gnuHash.IsValid())
+            return gnuHash.GetSymbolByName(module, name, impl::GnuHash(name));
+
         impl::ElfHashType hash = impl::ElfHash(name);
 
         for (uint32_t i = module->hash_bucket[hash % module->hash_nbucket_value];
@@ -78,17 +115,6 @@ namespace exl::reloc {
         return nullptr;
     }
 
-    inline Elf_Sym* GetSymbol(const char* name) {
-        for(auto i = static_cast<int>(util::ModuleIndex::Start); i < static_cast<int>(util::ModuleIndex::End); i++) {
-            auto index = static_cast<util::ModuleIndex>(i);
-            /* Ignore non-existent modules. */
-            if(!util::HasModule(index))
-                continue;
-             
-            auto res = GetSymbol(index, name);
-            if(res != nullptr)
-                return res;
-        }
-
-    }
+    /* Searches every module in index order. Results are cached, including names that weren't found. */
+    Elf_Sym* GetSymbol(const char* name);
 }
@@ -0,0 +1,165 @@
+#include "symbolizer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <mutex>
+
+#include <lib/reloc/reloc.hpp>
+#include <lib/util/sys/address_index.hpp>
+#include <lib/util/sys/spin_lock.hpp>
+#include <lib/log/logger_mgr.hpp>
+#include <program/loggers.hpp>
+#include <program/setting.hpp>
+
+namespace exl::reloc {
+
+    namespace {
+
+        /* Symbols are stored relative to their module, which keeps an entry at 8 bytes. */
+        struct SymbolizerEntry {
+            u32 m_Offset;
+            u32 m_SymbolIndex;
+        };
+
+        /* The run of entries that belongs to a module. */
+        struct ModuleSymbols {
+            u32 m_Begin;
+            u32 m_End;
+        };
+
+        static_assert(setting::SymbolizerEntryCount <= UINT32_MAX, "");
+
+        constinit util::SpinLock s_SymbolizerLock;
+        constinit std::array<SymbolizerEntry, setting::SymbolizerEntryCount> s_Entries {};
+        constinit std::array<ModuleSymbols, static_cast<size_t>(util::ModuleIndex::End)> s_Modules {};
+        /* One past the module layout generation the entries were built against, so zero means they never were. */
+        constinit std::atomic<u32> s_BuiltGeneration {};
+
+        size_t GetSymbolCount(util::ModuleIndex index, const rtld::ModuleObject* module) {
+            if(module->hash_bucket != nullptr)
+                return module->hash_nchain_value;
+
+            /* DT_GNU_HASH doesn't store the count, the last symbol is the end of the chain of the highest bucket. */
+            const auto& gnuHash = impl::GetModuleGnuHash(index);
+            if(!gnuHash.IsValid())
+                return 0;
+
+            u32 last = *std::max_element(gnuHash.buckets, gnuHash.buckets + gnuHash.nbucket);
+            if(last < gnuHash.symoffset)
+                return gnuHash.symoffset;
+
+            while((gnuHash.chain[last - gnuHash.symoffset] & 1) == 0)
+                last++;
+
+            return last + 1;
+        }
+
+        bool IsSymbolizable(const Elf_Sym& symbol) {
+            const auto type = ELF64_ST_TYPE(symbol.st_info);
+            return symbol.st_shndx != SHN_UNDEF && symbol.st_value != 0 && (type == STT_FUNC || type == STT_OBJECT);
+        }
+
+        /* Must be called with the lock held. */
+        void BuildEntries() {
+            u32 count = 0;
+            size_t droppedCount = 0;
+
+            for(auto i = static_cast<int>(util::ModuleIndex::Start); i < static_cast<int>(util::ModuleIndex::End); i++) {
+                const auto index = static_cast<util::ModuleIndex>(i);
+                const u32 begin = count;
+                s_Modules[i] = { begin, begin };
+
+                /* Ignore non-existent modules. */
+                if(!util::HasModule(index))
+                    continue;
+
+                const auto module = impl::GetModuleRuntime(index);
+                const size_t symbolCount = GetSymbolCount(index, module);
+                for(size_t symbolIndex = 0; symbolIndex < symbolCount; symbolIndex++) {
+                    const auto& symbol = module->dynsym[symbolIndex];
+                    if(!IsSymbolizable(symbol))
+                        continue;
+
+                    if(count == s_Entries.size()) {
+                        droppedCount++;
+                        continue;
+                    }
+
+                    s_Entries[count++] = { static_cast<u32>(symbol.st_value), static_cast<u32>(symbolIndex) };
+                }
+
+                std::sort(s_Entries.begin() + begin, s_Entries.begin() + count, [](const SymbolizerEntry& lhs, const SymbolizerEntry& rhs) {
+                    return lhs.m_Offset < rhs.m_Offset;
+                });
+                s_Modules[i].m_End = count;
+            }
+
+            if(droppedCount != 0)
+                Logging.Log(EXL_LOG_PREFIX "Symbolizer is full, %lu symbols were left out. Raise setting::SymbolizerEntryCount to include them.", droppedCount);
+        }
+
+        /* Returns false if the entries aren't up to date and wait is false while someone else is building them. */
+        bool EnsureEntries(bool wait) {
+            const u32 generation = util::GetModuleLayoutGeneration() + 1;
+            if(EXL_LIKELY(s_BuiltGeneration.load(std::memory_order_acquire) == generation))
+                return true;
+
+            std::unique_lock lock(s_SymbolizerLock, std::defer_lock);
+            if(wait)
+                lock.lock();
+            else if(!lock.try_lock())
+                return false;
+
+            if(s_BuiltGeneration.load(std::memory_order_relaxed) == generation)
+                return true;
+
+            BuildEntries();
+            s_BuiltGeneration.store(generation, std::memory_order_release);
+            return true;
+        }
+
+        bool SymbolizeImpl(uintptr_t address, SymbolizedAddress* out, bool wait) {
+            util::ModuleAddress moduleAddress;
+            if(!util::TryGetModuleAddress(address, &moduleAddress))
+                return false;
+
+            *out = {
+                .m_Module = moduleAddress.m_Module,
+                .m_ModuleOffset = moduleAddress.m_Offset,
+                .m_Symbol = nullptr,
+                .m_SymbolName = nullptr,
+                .m_SymbolOffset = moduleAddress.m_Offset,
+            };
+
+            if(!EnsureEntries(wait))
+                return true;
+
+            /* Find the last symbol starting at or before the address. */
+            const auto& symbols = s_Modules[static_cast<int>(moduleAddress.m_Module)];
+            const auto begin = s_Entries.begin() + symbols.m_Begin;
+            const auto end = s_Entries.begin() + symbols.m_End;
+            auto it = std::upper_bound(begin, end, moduleAddress.m_Offset, [](uintptr_t offset, const SymbolizerEntry& entry) {
+                return offset < entry.m_Offset;
+            });
+            if(it == begin)
+                return true;
+
+            it--;
+            const auto module = impl::GetModuleRuntime(moduleAddress.m_Module);
+            const auto& symbol = module->dynsym[it->m_SymbolIndex];
+            out->m_Symbol = &symbol;
+            out->m_SymbolName = module->dynstr + symbol.st_name;
+            out->m_SymbolOffset = moduleAddress.m_Offset - it->m_Offset;
+            return true;
+        }
+    }
+
+    bool Symbolize(uintptr_t address, SymbolizedAddress* out) {
+        return SymbolizeImpl(address, out, true);
+    }
+
+    bool TrySymbolize(uintptr_t address, SymbolizedAddress* out) {
+        return SymbolizeImpl(address, out, false);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <common.hpp>
+#include <rtld.hpp>
+#include <lib/util/module_index.hpp>
+
+namespace exl::reloc {
+
+    struct SymbolizedAddress {
+        util::ModuleIndex m_Module;
+        /* Relative to the start of the module. */
+        uintptr_t m_ModuleOffset;
+        /* The closest dynamic symbol at or before the address within its module, null if there's none. */
+        const Elf_Sym* m_Symbol;
+        const char* m_SymbolName;
+        /* Relative to the start of the symbol, or the module if there's no symbol. */
+        uintptr_t m_SymbolOffset;
+    };
+
+    /*
+        Maps an address to its module and the nearest preceding dynamic symbol, in O(log n) for both.
+        The symbols of every module are gathered into one sorted array on first use, and again when the module layout changes.
+        Returns false if the address isn't in a static module.
+    */
+    bool Symbolize(uintptr_t address, SymbolizedAddress* out);
+
+    /*
+        Like Symbolize, but never waits on the symbols being gathered, only the module and its offset are filled in then.
+        For abort paths, which may have been entered while gathering them with the lock held.
+    */
+    bool TrySymbolize(uintptr_t address, SymbolizedAddress* out);
+}
\ No newline at end of file
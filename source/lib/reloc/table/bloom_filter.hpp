@@ -0,0 +1,48 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <span>
+
+#include "lookup_entry.hpp"
+
+namespace exl::reloc {
+
+    /*
+        Blocked bloom filter over the symbol hashes of a table, used to reject names before searching the table.
+        Both bits of a hash land in the same word, so a query is a single load. The word is picked from the low bits of the hash
+        and the bits within it from the high bits, at 16 bits per entry this gives roughly a 2% false positive rate.
+    */
+    using FilterBin = std::span<const uint64_t>;
+
+    namespace impl {
+        constexpr size_t GetFilterWordCount(size_t entryCount) {
+            return std::bit_ceil(std::max<size_t>(entryCount / 4, 1));
+        }
+
+        constexpr uint64_t GetFilterMask(HashType hash) {
+            return (1ull << ((hash >> 20) & 63)) | (1ull << ((hash >> 26) & 63));
+        }
+
+        template<size_t WordCount, size_t Size>
+        constexpr auto BuildFilter(const std::array<LookupEntryBin, Size>& entries) {
+            static_assert(std::has_single_bit(WordCount), "Word count must be a power of two.");
+
+            std::array<uint64_t, WordCount> filter {};
+            for(const auto& entry : entries)
+                filter[entry.m_SymbolHash & (WordCount - 1)] |= GetFilterMask(entry.m_SymbolHash);
+            return filter;
+        }
+    }
+
+    /* An empty filter can't reject anything. */
+    constexpr bool FilterMayContain(FilterBin filter, HashType hash) {
+        if(filter.empty())
+            return true;
+
+        const auto mask = impl::GetFilterMask(hash);
+        return (filter[hash & (filter.size() - 1)] & mask) == mask;
+    }
+}
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include <rtld.hpp>
 #include <bitset>
 #include <cstring>
+#include <new>
 #include <lib/util/module_index.hpp>
 #include <lib/util/sys/mem_layout.hpp>
 #include <lib/util/strings.hpp>
@@ -10,9 +11,15 @@
 #include <lib/reloc/reloc.hpp>
 #include <lib/log/logger_mgr.hpp>
 #include <program/loggers.hpp>
+#include <program/setting.hpp>
 
 #include <lib/util/sys/mem_layout.hpp>
 
+/* Provided by linkerscript, the PLT header every jump slot points to until it's bound. */
+extern "C" {
+    extern char __plt_start__;
+}
+
 namespace exl::reloc {
     
     template<typename T>
@@ -68,89 +75,204 @@ namespace exl::reloc {
 
     namespace {
 
-        void ApplyRel(const LookupEntryBin& entry, std::string_view symbolName, std::uint32_t type, uintptr_t* target, ptrdiff_t addend) {
-            auto referredModule = util::GetModuleInfo(entry.m_ModuleIndex);
-            if(Logging.IsEnabled()) {
-                char nameBuffer[util::ModuleInfo::s_ModulePathLengthMax+1];
-                util::CopyString(nameBuffer, referredModule.GetModuleName());
-                Logging.Log(EXL_LOG_PREFIX "Symbol %s being relocated to [%s]+%x", symbolName.data(), nameBuffer, entry.m_Offset);
-            }
-
+        void ApplyRel(const LookupEntryBin& entry, uintptr_t* target, ptrdiff_t addend) {
             /* Target address will be (referred module start + offset) + rel addend. */
-            *target = static_cast<uintptr_t>(referredModule.m_Total.m_Start + entry.m_Offset + addend);
+            *target = static_cast<uintptr_t>(util::GetModuleInfo(entry.m_ModuleIndex).m_Total.m_Start + entry.m_Offset + addend);
         }
 
-        void CheckAndApplyRel(const Lookup& table, SymAccessor symbol, std::uint32_t type, uintptr_t* target, ptrdiff_t addend) {
-            auto symbolName = symbol.GetName();
-            auto search = table.FindByName(symbolName);
-            if(search == nullptr)
-                return;
-                
+        const LookupEntryBin* MatchRel(const Lookup& table, SymAccessor symbol, std::uint32_t type, bool log) {
+            /* Checked first, as it doesn't need the symbol name. Most relocations are relative ones and stop here. */
             if(
                 /* If it's not a jump slot, rel absolute, or a global data, we will not apply it. */
                 type != ARCH_JUMP_SLOT &&
                 !(ARCH_IS_REL_ABSOLUTE(type)) &&
                 type != ARCH_GLOB_DAT
             ) {
-                return;
+                return nullptr;
             }
 
+            /* Names not in the table are mostly rejected by the filter before the table is searched. */
+            auto symbolName = symbol.GetName();
+            auto search = table.FindByName(symbolName);
+            if(search == nullptr)
+                return nullptr;
 
             if(!util::HasModule(search->m_ModuleIndex)) {
-                Logging.Log(EXL_LOG_PREFIX "Symbol %s has invalid module index %d", symbolName.data(), static_cast<int>(search->m_ModuleIndex));
-                return;
+                if(log)
+                    Logging.Log(EXL_LOG_PREFIX "Symbol %s has invalid module index %d", symbolName.data(), static_cast<int>(search->m_ModuleIndex));
+                return nullptr;
             }
 
-            ApplyRel(*search, symbolName, type, target, addend);
+            if(log && Logging.IsEnabled()) {
+                char nameBuffer[util::ModuleInfo::s_ModulePathLengthMax+1];
+                util::CopyString(nameBuffer, util::GetModuleInfo(search->m_ModuleIndex).GetModuleName());
+                Logging.Log(EXL_LOG_PREFIX "Symbol %s being relocated to [%s]+%x", symbolName.data(), nameBuffer, search->m_Offset);
+            }
+
+            return search;
         }
 
-        template<typename T>
+        bool IsEagerBindSymbol(std::string_view name) {
+            for(auto symbol : setting::EagerBindSymbols) {
+                if(symbol == name)
+                    return true;
+            }
+            return false;
+        }
+
+        /* Only calls can go through the resolver, anything that takes the address needs it up front. */
+        bool IsLazyBound(SymAccessor symbol, std::uint32_t type) {
+            if constexpr(!setting::LazyBindRelocations)
+                return false;
+
+            return type == ARCH_JUMP_SLOT && !IsEagerBindSymbol(symbol.GetName());
+        }
+
+        template<typename T, typename Visitor>
         requires IsElfRel<T>
-        void ApplyRels(const Lookup& table, const rtld::ModuleObject& mod, const T* ptr, size_t size) {
+        void ScanRels(const Lookup& table, const rtld::ModuleObject& mod, const T* ptr, size_t size, bool log, Visitor& visitor) {
             std::span<const T> span { ptr, size / sizeof(T) };
             for(auto rel : span) {
                 auto accessor = RelAccessor<T> { rel, mod };
-                CheckAndApplyRel(
-                    table,
-                    accessor.GetSym(),
-                    accessor.GetType(),
-                    accessor.GetTarget(),
-                    accessor.GetAddend()
-                );
+                auto entry = MatchRel(table, accessor.GetSym(), accessor.GetType(), log);
+                if(entry != nullptr)
+                    visitor(RelocationPlanEntry { accessor.GetTarget(), entry, accessor.GetAddend() }, IsLazyBound(accessor.GetSym(), accessor.GetType()));
             }
         }
 
-        void ApplyRels(const Lookup& table, const rtld::ModuleObject& mod) {
+        /* Calls visitor with every relocation, dynamic and PLT, that resolves through the table, and whether it may be bound lazily. */
+        template<typename Visitor>
+        void ScanRelocations(const Lookup& table, const rtld::ModuleObject& mod, bool log, Visitor visitor) {
             bool hasRel = (mod.rel_count != 0) || (mod.rel_dyn_size != 0);
             bool hasRela = (mod.rela_count != 0) || (mod.rela_dyn_size != 0);
 
             EXL_ASSERT(hasRel != hasRela);
             
             if(hasRela) {
-                ApplyRels<Elf_Rela>(table, mod, mod.rela_or_rel.rela, mod.rela_dyn_size);
+                ScanRels<Elf_Rela>(table, mod, mod.rela_or_rel.rela, mod.rela_dyn_size, log, visitor);
             } else {
-                ApplyRels<Elf_Rel>(table, mod, mod.rela_or_rel.rel, mod.rel_dyn_size);
+                ScanRels<Elf_Rel>(table, mod, mod.rela_or_rel.rel, mod.rel_dyn_size, log, visitor);
             }
-        }
 
-        void ApplyPlt(const Lookup& table, const rtld::ModuleObject& mod) {
             if(mod.is_rela) {
-                ApplyRels<Elf_Rela>(table, mod, mod.rela_or_rel_plt.rela, mod.rela_or_rel_plt_size);
+                ScanRels<Elf_Rela>(table, mod, mod.rela_or_rel_plt.rela, mod.rela_or_rel_plt_size, log, visitor);
             } else {
-                ApplyRels<Elf_Rel>(table, mod, mod.rela_or_rel_plt.rel, mod.rela_or_rel_plt_size);
+                ScanRels<Elf_Rel>(table, mod, mod.rela_or_rel_plt.rel, mod.rela_or_rel_plt_size, log, visitor);
             }
         }
+
+        void InitializeSelfModule(rtld::ModuleObject* modObj) {
+            auto info = util::GetSelfModuleInfo();
+            *modObj = {};
+            modObj->Initialize(
+                reinterpret_cast<char*>(info.m_Total.m_Start), 
+                const_cast<Elf_Dyn*>(info.m_Mod->GetDynamic())
+            );
+        }
+
+        /* The resolver finds the module through GOT[1], so it has to outlive the plan. */
+        rtld::ModuleObject s_LazyModule;
+        constinit const Lookup* s_LazyLookup = nullptr;
+
+        Elf_Addr LookupLazySymbol(const char* name) {
+            auto entry = s_LazyLookup->FindByName(std::string_view(name, std::strlen(name)));
+            if(entry == nullptr || !util::HasModule(entry->m_ModuleIndex))
+                return 0;
+
+            /* The resolver adds the relocation's addend itself. */
+            return static_cast<Elf_Addr>(util::GetModuleInfo(entry->m_ModuleIndex).m_Total.m_Start + entry->m_Offset);
+        }
+
+        void PrepareLazyBinding(const Lookup& table, RelocationPlan lazy) {
+            if(s_LazyModule.module_base == nullptr)
+                InitializeSelfModule(&s_LazyModule);
+
+            EXL_ASSERT(s_LazyModule.got != nullptr);
+
+            s_LazyLookup = &table;
+            /* Only binds of our own module go through the table, the game's and sdk's imports are left to rtld. */
+            rtld::g_LookupLazyModule = &s_LazyModule;
+            rtld::g_LookupLazyFunctionPointer = LookupLazySymbol;
+
+            /* The PLT header jumps to GOT[2] with GOT[1] in reach, just like the system rtld sets up modules it binds lazily. */
+            s_LazyModule.got[1] = &s_LazyModule;
+            s_LazyModule.got[2] = reinterpret_cast<void*>(rtld::__rtld_runtime_resolve);
+
+            for(const auto& entry : lazy)
+                *entry.m_Target = reinterpret_cast<uintptr_t>(&__plt_start__);
+        }
     }
 
-    void Lookup::Apply() const {
+    bool Lookup::BuildPlan() {
+        delete[] m_Plan.data();
+        m_Plan = {};
+        m_HasPlan = false;
+        m_LazyCount = 0;
+
+        rtld::ModuleObject modObj;
+        InitializeSelfModule(&modObj);
+
+        /* Count first so the plan is a single allocation of exactly the right size, only the second pass logs. */
+        size_t count = 0;
+        size_t lazyCount = 0;
+        ScanRelocations(*this, modObj, false, [&count, &lazyCount](const RelocationPlanEntry&, bool lazy) {
+            count++;
+            lazyCount += lazy;
+        });
+
+        auto plan = new (std::nothrow) RelocationPlanEntry[count];
+        if(plan == nullptr) {
+            Logging.Log(EXL_LOG_PREFIX "Failed to allocate a relocation plan of %lu entries", count);
+            return false;
+        }
+
+        /* Eager entries fill the plan from the front and lazy ones from the back. */
+        size_t index = 0;
+        size_t lazyIndex = count - lazyCount;
+        ScanRelocations(*this, modObj, true, [plan, &index, &lazyIndex](const RelocationPlanEntry& entry, bool lazy) {
+            plan[lazy ? lazyIndex++ : index++] = entry;
+        });
+        EXL_ASSERT(index == count - lazyCount && lazyIndex == count);
+
+        m_Plan = std::span { plan, count };
+        m_PlanEntries = m_Entries.data();
+        m_HasPlan = true;
+        m_LazyCount = lazyCount;
+        return true;
+    }
+
+    void Lookup::ApplyPlan() const {
+        for(const auto& entry : m_Plan.first(m_Plan.size() - m_LazyCount))
+            ApplyRel(*entry.m_Entry, entry.m_Target, entry.m_Addend);
+
+        if(m_LazyCount != 0)
+            PrepareLazyBinding(*this, GetLazyPlan());
+    }
+
+    void Lookup::DumpPlan() const {
+        Logging.Log(EXL_LOG_PREFIX "Relocation plan, %lu entries, %lu bound lazily:", m_Plan.size(), m_LazyCount);
+        for(size_t i = 0; i < m_Plan.size(); i++) {
+            const auto& entry = m_Plan[i];
+            char nameBuffer[util::ModuleInfo::s_ModulePathLengthMax+1];
+            util::CopyString(nameBuffer, util::GetModuleInfo(entry.m_Entry->m_ModuleIndex).GetModuleName());
+            Logging.Log(EXL_LOG_PREFIX "  %p <- [%s]+%x%+ld (hash %08x)%s", entry.m_Target, nameBuffer, entry.m_Entry->m_Offset, entry.m_Addend, entry.m_Entry->m_SymbolHash,
+                i >= m_Plan.size() - m_LazyCount ? " lazy" : "");
+        }
+    }
+
+    void Lookup::Apply() {
         Logging.Log(EXL_LOG_PREFIX "Applying relocations...");
-        auto info = util::GetSelfModuleInfo();
-        rtld::ModuleObject modObj = {};
-        modObj.Initialize(
-            reinterpret_cast<char*>(info.m_Total.m_Start), 
-            const_cast<Elf_Dyn*>(info.m_Mod->GetDynamic())
-        );
-        ApplyRels(*this, modObj);
-        ApplyPlt(*this, modObj);
+
+        if(!m_HasPlan || m_PlanEntries != m_Entries.data()) {
+            if(!BuildPlan()) {
+                /* Without room for a plan, resolve straight from the relocation tables. Everything is bound up front then, as nothing remembers the lazy slots. */
+                rtld::ModuleObject modObj;
+                InitializeSelfModule(&modObj);
+                ScanRelocations(*this, modObj, true, [](const RelocationPlanEntry& entry, bool) { ApplyRel(*entry.m_Entry, entry.m_Target, entry.m_Addend); });
+                return;
+            }
+        }
+
+        ApplyPlan();
     }
 }
\ No newline at end of file
@@ -1,40 +1,85 @@
 #pragma once
 
+#include <bit>
 #include <common.hpp>
 #include <span>
 #include <string_view>
+#include "bloom_filter.hpp"
 #include "lookup_entry.hpp"
 
 namespace exl::reloc {
+
+    /* A relocation of the running module that resolves through the lookup table. */
+    struct RelocationPlanEntry {
+        uintptr_t* m_Target;
+        const LookupEntryBin* m_Entry;
+        ptrdiff_t m_Addend;
+    };
+    using RelocationPlan = std::span<const RelocationPlanEntry>;
     
     /* TODO: organize this to be a bit more flexible... */
     struct Lookup {
         NON_COPYABLE(Lookup);
         NON_MOVEABLE(Lookup);
 
+        /* Laid out in Eytzinger order, see TableType. */
         std::span<const LookupEntryBin> m_Entries;
+        /* Optional, FindByName skips the table search for names it rejects. */
+        FilterBin m_Filter;
+
+        /* Built by Apply against the entries at the time, so applying again is a single pass over it. */
+        std::span<RelocationPlanEntry> m_Plan;
+        const LookupEntryBin* m_PlanEntries = nullptr;
+        bool m_HasPlan = false;
+        /* Jump slots bound on their first call rather than by ApplyPlan, kept at the end of the plan. */
+        size_t m_LazyCount = 0;
 
         Lookup() = default;
-        Lookup(std::span<const LookupEntryBin> entries) : m_Entries(entries) {}
+        Lookup(std::span<const LookupEntryBin> entries, FilterBin filter = {}) : m_Entries(entries), m_Filter(filter) {}
 
         ALWAYS_INLINE const auto& GetEntries() const {
             return m_Entries;
         }
 
         inline constexpr const LookupEntryBin* FindByHash(HashType hash) const {
-            auto low = std::lower_bound(m_Entries.begin(), m_Entries.end(), hash);
+            /* Walk down the tree using one based node indices, so the children of node k are 2k and 2k+1. */
+            size_t k = 1;
+            while(k <= m_Entries.size())
+                k = 2 * k + (m_Entries[k - 1].m_SymbolHash < hash);
 
-            if(low->m_SymbolHash != hash)
+            /* Every right turn taken after the last left one shows up as a trailing one, undo those and the left turn to get the lower bound. */
+            k >>= std::countr_one(k) + 1;
+
+            /* Zero when the hash is greater than every entry. */
+            if(k == 0 || m_Entries[k - 1].m_SymbolHash != hash)
                 return nullptr;
 
-            return low.base();
+            return &m_Entries[k - 1];
         }
 
         inline const LookupEntryBin* FindByName(std::string_view string) const {
             auto hash = util::Murmur3::Compute(std::span { string.data(), string.size() });
+            if(!FilterMayContain(m_Filter, hash))
+                return nullptr;
+
             return FindByHash(hash);
         }
-        
-        void Apply() const;
+
+        ALWAYS_INLINE RelocationPlan GetPlan() const {
+            return m_Plan;
+        }
+
+        ALWAYS_INLINE RelocationPlan GetLazyPlan() const {
+            return m_Plan.last(m_LazyCount);
+        }
+
+        /* Scans the module's relocations for ones the table resolves. Returns false if the plan couldn't be allocated. */
+        bool BuildPlan();
+        /* Lazy entries are pointed at the PLT stub, which resolves them through this table when first called. */
+        void ApplyPlan() const;
+        void DumpPlan() const;
+
+        /* Builds the plan if the entries changed since it was last built, then applies it. */
+        void Apply();
     };
 }
\ No newline at end of file
@@ -1,8 +1,10 @@
 #pragma once
 
 #include <span>
+#include <type_traits>
 #include <utility>
 
+#include "bloom_filter.hpp"
 #include "lookup_entry.hpp"
 
 namespace exl::reloc {
@@ -25,6 +27,24 @@ namespace exl::reloc {
             std::sort(sorted.begin(), sorted.end());
             return sorted;
         }
+
+        /* Places sorted[i...] at node k and its subtrees, returns the next unplaced index. */
+        template<typename Array>
+        constexpr size_t FillEytzinger(const Array& sorted, Array& out, size_t i, size_t k) {
+            if(k < out.size()) {
+                i = FillEytzinger(sorted, out, i, 2 * k + 1);
+                out[k] = sorted[i++];
+                i = FillEytzinger(sorted, out, i, 2 * k + 2);
+            }
+            return i;
+        }
+
+        /* Lays out a sorted array as an implicit binary search tree, where the children of node k are at 2k+1 and 2k+2. */
+        static constexpr const auto ToEytzinger(const auto sorted) {
+            std::remove_const_t<decltype(sorted)> out {};
+            FillEytzinger(sorted, out, 0, 0);
+            return out;
+        }
     }
 
     template<impl::LookupEntry... Table>
@@ -35,11 +55,19 @@ namespace exl::reloc {
 
         static constexpr Array s_UnsortedTable { Table.Convert()... };
         static constexpr Array s_SortedTable = impl::Sort(s_UnsortedTable);
+        /* Searched by Lookup::FindByHash, the top levels of the tree end up sharing a few cache lines. */
+        static constexpr Array s_EytzingerTable = impl::ToEytzinger(s_SortedTable);
 
         /* Ensure the symbol strings are unique. */
         static_assert(impl::IsUnique(std::array<std::string_view, s_Size> {Table.GetSymbol()...}), "Duplicate symbol!");
+        /* Check if any of the entries in the table have the same symbol hash. This can occur if there happens to be a collision. */
+        static_assert(impl::IsUnique(s_SortedTable, [](const LookupEntryBin& v) { return v.m_SymbolHash; }), "Symbol name hash collision!");
+
+        using FilterArray = std::array<uint64_t, impl::GetFilterWordCount(s_Size)>;
+        static constexpr FilterArray s_Filter = impl::BuildFilter<impl::GetFilterWordCount(s_Size)>(s_SortedTable);
 
-        Array m_Table = s_SortedTable;
+        Array m_Table = s_EytzingerTable;
+        FilterArray m_Filter = s_Filter;
     };
     template<auto Version, impl::LookupEntry... Table>
     struct VersionedTable : public TableType<Table...> {
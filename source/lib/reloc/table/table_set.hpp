@@ -30,11 +30,6 @@ namespace exl::reloc {
 
         template<size_t... Indicies>
         ALWAYS_INLINE TableBin GetTableByIndexImpl(size_t index, std::index_sequence<Indicies...>) const {
-            /* Check if any of the entries in the table have the same symbol hash. This can occur if there happens to be a collision. */
-            static_assert(
-                (true && ... && impl::IsUnique(std::get<Indicies>(s_Map).m_Table, [](const LookupEntryBin& v) { return v.m_SymbolHash; })),
-                "Symbol name hash collision!"
-            );
             /* Create array of spans to access tables at runtime by index. */
             static constexpr auto tables = std::array<TableBin, s_Count> {
                 (TableBin(
@@ -54,6 +49,24 @@ namespace exl::reloc {
             return GetTableByIndexImpl(index, std::make_index_sequence<s_Count>{});
         }
 
+        template<size_t... Indicies>
+        ALWAYS_INLINE FilterBin GetFilterByIndexImpl(size_t index, std::index_sequence<Indicies...>) const {
+            static constexpr auto filters = std::array<FilterBin, s_Count> {
+                (FilterBin(
+                    std::get<Indicies>(s_Map).m_Filter.data(),
+                    std::get<Indicies>(s_Map).m_Filter.size()
+                ))...
+            };
+
+            EXL_ABORT_UNLESS(0 <= index && index < s_Count);
+
+            return filters[index];
+        }
+
+        inline FilterBin GetFilterByIndex(size_t index) const {
+            return GetFilterByIndexImpl(index, std::make_index_sequence<s_Count>{});
+        }
+
         public:
         inline bool DoesTableExist(VersionType type) const {
             return FindTableIndex(type) != SIZE_MAX;
@@ -63,5 +76,10 @@ namespace exl::reloc {
             EXL_ABORT_UNLESS(index != SIZE_MAX);
             return GetTableByIndex(index);
         }
+        ALWAYS_INLINE FilterBin GetFilter(VersionType type) const {
+            auto index = FindTableIndex(type);
+            EXL_ABORT_UNLESS(index != SIZE_MAX);
+            return GetFilterByIndex(index);
+        }
     };
 }
\ No newline at end of file
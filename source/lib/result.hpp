@@ -43,4 +43,5 @@ namespace exl::result {
     constexpr Result FailedToFindTarget                         = MakeResult(ExlModule, 4);
     constexpr Result TooManyStaticModules                       = MakeResult(ExlModule, 5);
     constexpr Result VirtualMemberFunctionPointerNotSupported   = MakeResult(ExlModule, 6);
+    constexpr Result JitOutOfMemory                             = MakeResult(ExlModule, 7);
 }
\ No newline at end of file
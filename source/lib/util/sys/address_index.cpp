@@ -0,0 +1,36 @@
+#include "address_index.hpp"
+
+namespace exl::util {
+
+    namespace impl::mem_layout {
+        std::array<SegmentRange, s_SegmentCountMax> s_Segments;
+        size_t s_SegmentCount = 0;
+
+        void BuildAddressIndex() {
+            s_SegmentCount = 0;
+
+            auto add = [](const Range& range, ModuleIndex module, ModuleSegment segment) {
+                if(range.m_Size == 0)
+                    return;
+                s_Segments[s_SegmentCount++] = { range.m_Start, range.GetEnd(), module, segment };
+            };
+
+            for(int i = static_cast<int>(ModuleIndex::Start); i < static_cast<int>(ModuleIndex::End); i++) {
+                /* Ignore non-existent modules. */
+                if(!s_ModuleBitset[i])
+                    continue;
+
+                const auto index = static_cast<ModuleIndex>(i);
+                const auto& module = s_ModuleInfos[i];
+                add(module.m_Text, index, ModuleSegment::Text);
+                add(module.m_Rodata, index, ModuleSegment::Rodata);
+                add(module.m_Data, index, ModuleSegment::Data);
+            }
+
+            /* Modules aren't discovered in address order once the sdk is moved to its own index. */
+            std::sort(s_Segments.begin(), s_Segments.begin() + s_SegmentCount, [](const SegmentRange& lhs, const SegmentRange& rhs) {
+                return lhs.m_Start < rhs.m_Start;
+            });
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <common.hpp>
+#include <lib/util/module_index.hpp>
+
+#include "mem_layout.hpp"
+
+namespace exl::util {
+
+    enum class ModuleSegment : u8 {
+        Text,
+        Rodata,
+        Data,
+        Count,
+    };
+
+    /* Where an address lies within the static modules. */
+    struct ModuleAddress {
+        ModuleIndex m_Module;
+        ModuleSegment m_Segment;
+        /* Relative to the start of the module, so it matches a disassembler with the module based at zero. */
+        uintptr_t m_Offset;
+    };
+
+    namespace impl::mem_layout {
+        struct SegmentRange {
+            uintptr_t m_Start;
+            uintptr_t m_End;
+            ModuleIndex m_Module;
+            ModuleSegment m_Segment;
+        };
+
+        constexpr size_t s_SegmentCountMax = static_cast<size_t>(ModuleIndex::End) * static_cast<size_t>(ModuleSegment::Count);
+
+        /* Every segment of every module sorted by address, rebuilt along with the module layout. */
+        extern std::array<SegmentRange, s_SegmentCountMax> s_Segments;
+        extern size_t s_SegmentCount;
+
+        void BuildAddressIndex();
+    }
+
+    /* Binary searches the segments, false if the address isn't in a static module. */
+    inline bool TryGetModuleAddress(uintptr_t address, ModuleAddress* out) {
+        const auto begin = impl::mem_layout::s_Segments.begin();
+        const auto end = begin + impl::mem_layout::s_SegmentCount;
+
+        /* Find the last segment starting at or before the address. */
+        auto it = std::upper_bound(begin, end, address, [](uintptr_t value, const impl::mem_layout::SegmentRange& segment) {
+            return value < segment.m_Start;
+        });
+        if(it == begin)
+            return false;
+
+        it--;
+        if(address >= it->m_End)
+            return false;
+
+        const auto& module = impl::mem_layout::s_ModuleInfos[static_cast<int>(it->m_Module)];
+        *out = { it->m_Module, it->m_Segment, address - module.m_Total.m_Start };
+        return true;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,46 @@
+#include "jit_pool.hpp"
+
+#include "lib/util/sys/cur_proc_handle.hpp"
+
+namespace exl::util {
+
+    Result CodePages::Map(size_t size) {
+        EXL_ASSERT(!IsMapped());
+        size = ALIGN_UP(size, PAGE_SIZE);
+
+        /* Code memory must be backed by memory owned by the process, it can't be accessed through the source anymore once mapped. */
+        void* source = aligned_alloc(PAGE_SIZE, size);
+        if(source == nullptr)
+            return result::JitOutOfMemory;
+
+        auto procHandle = proc_handle::Get();
+        Result rc = result::JitOutOfMemory;
+
+        virtmemLock();
+        auto rx = reinterpret_cast<uintptr_t>(virtmemFindCodeMemory(size, 0));
+        if(rx != 0) {
+            rc = svcMapProcessCodeMemory(procHandle, rx, reinterpret_cast<u64>(source), size);
+            if(R_SUCCEEDED(rc)) {
+                rc = svcSetProcessMemoryPermission(procHandle, rx, size, Perm_Rx);
+
+                /* Keep the range from being handed out again, only the RW view is ever unmapped. */
+                if(R_SUCCEEDED(rc) && virtmemAddReservation(reinterpret_cast<void*>(rx), size) == nullptr)
+                    rc = result::JitOutOfMemory;
+
+                if(R_FAILED(rc))
+                    R_ABORT_UNLESS(svcUnmapProcessCodeMemory(procHandle, rx, reinterpret_cast<u64>(source), size));
+            }
+        }
+        virtmemUnlock();
+
+        if(R_FAILED(rc)) {
+            free(source);
+            return rc;
+        }
+
+        ConstructAt(m_Pages, rx, size);
+        m_Rx = rx;
+        m_Size = size;
+        return result::Success;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <common.hpp>
+#include <cstring>
+#include <mutex>
+#include <new>
+
+#include "lib/util/typed_storage.hpp"
+#include "rw_pages.hpp"
+#include "spin_lock.hpp"
+
+namespace exl::util {
+
+    /*
+        Executable memory mapped at runtime, the counterpart to a Jit area which is reserved in .text at build time.
+        Page aligned heap memory is aliased as code into the current process and written to through a RwPages view.
+        Mappings are kept for the lifetime of the process, as code may still be running from them.
+    */
+    class CodePages {
+        NON_COPYABLE(CodePages);
+        NON_MOVEABLE(CodePages);
+
+        uintptr_t m_Rx = 0;
+        size_t m_Size = 0;
+        TypedStorage<RwPages> m_Pages;
+
+        public:
+        CodePages() = default;
+
+        /* Size is rounded up to pages. */
+        Result Map(size_t size);
+
+        inline bool IsMapped() const { return m_Rx != 0; }
+
+        inline uintptr_t GetRo() const { return m_Rx; }
+        inline uintptr_t GetRw() const { return GetReference(m_Pages).GetRw(); }
+        inline size_t GetSize() const { return m_Size; }
+    };
+
+    /*
+        Hands out fixed size slots of executable memory.
+        Slots are carved out of a static Jit area first, and once that is used up out of CodePages mapped GrowSize bytes at a time,
+        so builds that fit in the static area don't pay for anything more.
+        Released slots are linked into a free list through their RW view and handed out again before anything new is carved.
+    */
+    template<size_t SlotSize, size_t GrowSize>
+    class JitSlotPool {
+        public:
+        struct Slot {
+            uintptr_t m_Rx;
+            uintptr_t m_Rw;
+        };
+
+        private:
+        static_assert(SlotSize >= sizeof(Slot), "Released slots must be able to hold the free list link!");
+        static_assert(SlotSize % alignof(Slot) == 0, "");
+        static_assert(GrowSize >= SlotSize && ALIGN_UP(GrowSize, PAGE_SIZE) == GrowSize, "");
+
+        SpinLock m_Lock;
+        /* What is left of the area slots are currently carved from. */
+        uintptr_t m_Rx = 0;
+        uintptr_t m_Rw = 0;
+        size_t m_Remaining = 0;
+        Slot m_FreeHead {};
+        size_t m_ChunkCount = 0;
+
+        Result Grow() {
+            /* Never freed, see CodePages. */
+            auto* pages = new (std::nothrow) CodePages();
+            if(pages == nullptr)
+                return result::JitOutOfMemory;
+
+            if(Result rc = pages->Map(GrowSize); R_FAILED(rc)) {
+                delete pages;
+                return rc;
+            }
+
+            m_Rx = pages->GetRo();
+            m_Rw = pages->GetRw();
+            m_Remaining = pages->GetSize();
+            m_ChunkCount++;
+            return result::Success;
+        }
+
+        public:
+        constexpr JitSlotPool() = default;
+
+        /* Gives the pool its static area, must be called before anything is allocated. */
+        void Initialize(uintptr_t rx, uintptr_t rw, size_t size) {
+            std::scoped_lock lock(m_Lock);
+            m_Rx = rx;
+            m_Rw = rw;
+            m_Remaining = size;
+        }
+
+        Result Allocate(Slot* out) {
+            std::scoped_lock lock(m_Lock);
+
+            /* Recycle a released slot if there are any. */
+            if(m_FreeHead.m_Rx != 0) {
+                *out = m_FreeHead;
+                std::memcpy(&m_FreeHead, reinterpret_cast<const void*>(out->m_Rw), sizeof(Slot));
+                return result::Success;
+            }
+
+            /* Whatever is left of the current area is too small for a slot, so it is abandoned. */
+            if(m_Remaining < SlotSize)
+                R_TRY(Grow());
+
+            *out = { m_Rx, m_Rw };
+            m_Rx += SlotSize;
+            m_Rw += SlotSize;
+            m_Remaining -= SlotSize;
+            return result::Success;
+        }
+
+        /* The caller must ensure nothing will execute the slot anymore. */
+        void Release(const Slot& slot) {
+            std::scoped_lock lock(m_Lock);
+            std::memcpy(reinterpret_cast<void*>(slot.m_Rw), &m_FreeHead, sizeof(Slot));
+            m_FreeHead = slot;
+        }
+
+        size_t GetChunkCount() {
+            std::scoped_lock lock(m_Lock);
+            return m_ChunkCount;
+        }
+    };
+}
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "mem_layout.hpp"
+#include "address_index.hpp"
 
 #include <lib/log/logger_mgr.hpp>
 #include <lib/util/strings.hpp>
@@ -22,6 +23,7 @@ namespace exl::util {
     namespace impl::mem_layout {
         std::array<ModuleInfo, static_cast<int>(ModuleIndex::End)> s_ModuleInfos;
         std::bitset<static_cast<int>(ModuleIndex::End)> s_ModuleBitset;
+        u32 s_Generation = 0;
     }
 
     static void FindModules() {
@@ -257,7 +259,9 @@ namespace exl::util {
 
     void impl::InitMemLayout() {
         FindModules();
+        impl::mem_layout::BuildAddressIndex();
         FindRegions();
+        impl::mem_layout::s_Generation++;
 
         if(Logging.IsEnabled())
             LogLayout();
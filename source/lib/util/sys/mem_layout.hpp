@@ -23,9 +23,15 @@ namespace exl::util {
         namespace mem_layout {
             extern std::array<ModuleInfo, static_cast<int>(ModuleIndex::End)> s_ModuleInfos;
             extern std::bitset<static_cast<int>(ModuleIndex::End)> s_ModuleBitset;
+            extern u32 s_Generation;
         }
     }
 
+    /* Changes whenever the module layout is (re)discovered, so anything derived from it knows when to be rebuilt. */
+    inline u32 GetModuleLayoutGeneration() {
+        return impl::mem_layout::s_Generation;
+    }
+
     [[gnu::const]] inline bool HasModule(ModuleIndex index) {
         return impl::mem_layout::s_ModuleBitset[static_cast<int>(index)];
     }
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <common.hpp>
+#include <cstring>
+#include <span>
 #include <string_view>
 #include "mod0.hpp"
 
@@ -9,6 +11,7 @@
 namespace exl::util {
     struct ModuleInfo {
         static constexpr size_t s_ModulePathLengthMax = 0x200;
+        static constexpr size_t s_BuildIdSizeMax = 0x20;
 
         Range m_Total;
         Range m_Text;
@@ -41,6 +44,31 @@ namespace exl::util {
             return "";
         }
 
+        /* Scans .rodata for the GNU build ID note, as the loader doesn't keep the ID anywhere else. Empty if there's none. */
+        std::span<const std::uint8_t> GetBuildId() const {
+            struct {
+                std::uint32_t m_NameSize;
+                std::uint32_t m_DescSize;
+                std::uint32_t m_Type;
+                char m_Name[4];
+            }* note;
+            constexpr std::uint32_t NoteTypeBuildId = 3;
+
+            for(auto ptr = m_Rodata.m_Start; ptr + sizeof(*note) <= m_Rodata.GetEnd(); ptr += sizeof(std::uint32_t)) {
+                note = reinterpret_cast<decltype(note)>(ptr);
+                /* The type is checked first, as it rules out nearly every position. */
+                if(note->m_Type != NoteTypeBuildId || note->m_NameSize != sizeof(note->m_Name) || std::memcmp(note->m_Name, "GNU", sizeof(note->m_Name)) != 0)
+                    continue;
+
+                auto size = note->m_DescSize;
+                if(size == 0 || size > s_BuildIdSizeMax || ptr + sizeof(*note) + size > m_Rodata.GetEnd())
+                    continue;
+
+                return { reinterpret_cast<const std::uint8_t*>(ptr + sizeof(*note)), size };
+            }
+            return {};
+        }
+
         std::string_view GetModuleName() const {
             auto path = GetModulePath();
             if(path.empty())
@@ -2,6 +2,7 @@
 
 #include "module_info.hpp"
 #include "mem_layout.hpp"
+#include "address_index.hpp"
 
 namespace exl::util {
     namespace mem_layout {
@@ -24,18 +25,11 @@ namespace exl::util {
     #endif
 
     inline const ModuleInfo* TryGetModule(uintptr_t pointer) {
-        for(size_t i = static_cast<int>(ModuleIndex::Start); i < static_cast<int>(ModuleIndex::End); i++) {
-            /* Ignore non-existent modules. */
-            if(!impl::mem_layout::s_ModuleBitset[i])
-                continue;
-                
-            const ModuleInfo* module = &impl::mem_layout::s_ModuleInfos[i];
+        ModuleAddress address;
+        if(!TryGetModuleAddress(pointer, &address))
+            return nullptr;
 
-            if(module->m_Total.InRange(pointer))
-                return module;
-        }
-
-        return nullptr;
+        return &impl::mem_layout::s_ModuleInfos[static_cast<int>(address.m_Module)];
     }
 
     inline bool IsInModule(uintptr_t pointer, ModuleIndex module) {
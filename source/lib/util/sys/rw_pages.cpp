@@ -34,7 +34,7 @@ namespace exl::util {
         } while((meminfo.addr + meminfo.size) < end);
     }
 
-    RwPages::RwPages(uintptr_t ro, size_t size)  {
+    RwPages::RwPages(uintptr_t ro, size_t size, bool flush_on_destroy) : m_FlushOnDestroy(flush_on_destroy) {
         /* Initialize the claim with what we know. */
         m_Claim = {
             .m_Ro = ro,
@@ -85,8 +85,10 @@ namespace exl::util {
         const auto& claim = GetClaim();
 
         /* Flush data. */
-        armDCacheFlush((void*)claim.m_Rw, claim.m_Size);
-        armICacheInvalidate((void*)claim.m_Ro, claim.m_Size);
+        if(m_FlushOnDestroy) {
+            armDCacheFlush((void*)claim.m_Rw, claim.m_Size);
+            armICacheInvalidate((void*)claim.m_Ro, claim.m_Size);
+        }
 
         auto procHandle = proc_handle::Get();
         
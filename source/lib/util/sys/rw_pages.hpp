@@ -74,16 +74,20 @@ namespace exl::util {
 
             Claim m_Claim;
             bool m_Owner = true;
+            bool m_FlushOnDestroy = true;
 
         public:
-            RwPages(uintptr_t ro, size_t size);
+            /* Callers that do their own cache maintenance may opt out of the flush on destruction. */
+            RwPages(uintptr_t ro, size_t size, bool flush_on_destroy = true);
             
             /* Explicitly only allow moving. */
             RwPages(RwPages&& other) 
             : m_Claim(std::exchange(other.m_Claim, {})), 
-            m_Owner(std::exchange(other.m_Owner, false)) {}
+            m_Owner(std::exchange(other.m_Owner, false)),
+            m_FlushOnDestroy(other.m_FlushOnDestroy) {}
             RwPages& operator=(RwPages&& other) {
                 m_Claim = std::exchange(other.m_Claim, {});
+                m_FlushOnDestroy = other.m_FlushOnDestroy;
                 other.m_Owner = false;
                 return *this;
             }
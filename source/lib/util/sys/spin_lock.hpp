@@ -0,0 +1,28 @@
+#pragma once
+
+#include <atomic>
+#include <common.hpp>
+
+namespace exl::util {
+
+    /* Usable before nnSdk is initialized, so keep the critical sections short and bounded. Satisfies Lockable. */
+    class SpinLock {
+        std::atomic_flag m_Flag {};
+
+        public:
+        void lock() {
+            while (m_Flag.test_and_set(std::memory_order_acquire)) {
+                /* Yield in case the holder is preempted on this core. */
+                svcSleepThread(0);
+            }
+        }
+
+        bool try_lock() {
+            return !m_Flag.test_and_set(std::memory_order_acquire);
+        }
+
+        void unlock() {
+            m_Flag.clear(std::memory_order_release);
+        }
+    };
+}
\ No newline at end of file
@@ -2,16 +2,86 @@
 
 #include <cstdio>
 #include <lib/log/logger_mgr.hpp>
+#include <lib/util/xxhash.hpp>
+#include <lib/util/sys/modules.hpp>
 #include <program/loggers.hpp>
 
 namespace exl::util {
 
+    namespace {
+
+        using BuildIdString = std::array<char, ModuleInfo::s_BuildIdSizeMax * 2 + 1>;
+
+        std::string_view FormatBuildId(BuildIdString& buffer, std::span<const std::uint8_t> buildId) {
+            constexpr char Digits[] = "0123456789abcdef";
+            size_t length = 0;
+            for(auto byte : buildId) {
+                buffer[length++] = Digits[byte >> 4];
+                buffer[length++] = Digits[byte & 0xF];
+            }
+            buffer[length] = '\0';
+            return { buffer.data(), length };
+        }
+
+        const UserVersionInfo* FindByBuildId(std::string_view buildId) {
+            for(const auto& info : UserVersionInfos) {
+                if(!info.m_BuildId.empty() && buildId.starts_with(info.m_BuildId))
+                    return &info;
+            }
+            return nullptr;
+        }
+
+        const UserVersionInfo* FindByHash(u64 hash) {
+            for(const auto& info : UserVersionInfos) {
+                if(info.m_Hash != 0 && info.m_Hash == hash)
+                    return &info;
+            }
+            return nullptr;
+        }
+
+        u64 HashModule(const ModuleInfo& module) {
+            XxHash64 hash;
+            hash.Initialize();
+            hash.Update({ reinterpret_cast<const std::uint8_t*>(module.m_Text.m_Start), module.m_Text.m_Size });
+            hash.Update({ reinterpret_cast<const std::uint8_t*>(module.m_Rodata.m_Start), module.m_Rodata.m_Size });
+            return hash.Finalize();
+        }
+
+        UserVersion DetermineUserVersion() {
+            /* If the user has no versions, they aren't trying to use this feature. */
+            if constexpr(UserVersionInfos.empty())
+                return UserVersion::DEFAULT;
+
+            if(!HasModule(ModuleIndex::Main)) {
+                Logging.Log(EXL_LOG_PREFIX "No main module to determine the version from");
+                return UserVersion::DEFAULT;
+            }
+
+            const auto& main = GetMainModuleInfo();
+            BuildIdString buffer;
+            auto buildId = FormatBuildId(buffer, main.GetBuildId());
+
+            /* Known build IDs skip hashing the whole executable. */
+            if(auto info = FindByBuildId(buildId); info != nullptr)
+                return info->m_Version;
+
+            auto hash = HashModule(main);
+            if(auto info = FindByHash(hash); info != nullptr) {
+                Logging.Log(EXL_LOG_PREFIX "Matched by hash, add build ID %s to its entry to skip hashing", buffer.data());
+                return info->m_Version;
+            }
+
+            Logging.Log(EXL_LOG_PREFIX "Unknown main module, build ID %s, hash 0x%016lx", buffer.data(), hash);
+            return UserVersion::DEFAULT;
+        }
+    }
+
     namespace impl {
         UserVersion s_UserVersion;
 
         void InitVersion() {
             Logging.Log(EXL_LOG_PREFIX "Determining user version...");
-            s_UserVersion = impl::DetermineUserVersion();
+            s_UserVersion = DetermineUserVersion();
             Logging.Log(EXL_LOG_PREFIX "User version: %d", s_UserVersion);
         }
     }
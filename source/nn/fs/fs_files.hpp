@@ -11,6 +11,19 @@ namespace nn::fs {
     */
     Result CreateFile(char const* path, s64 size);
 
+    /*
+        Delete a file.
+        path: Path of the file to delete.
+    */
+    Result DeleteFile(char const* path);
+
+    /*
+        Rename a file.
+        currentPath: Path of the file to rename.
+        newPath:     Path to move the file to.
+    */
+    Result RenameFile(char const* currentPath, char const* newPath);
+
     /*
         Open a file.
         outHandle:   Output for handle representing opened file.
@@ -1,21 +1,19 @@
 #include "compile.hpp"
+#include "heap.hpp"
 
 #include "lib.hpp"
 #include "loggers.hpp"
 
 void* Alloc(size_t size, size_t align, void* userData) {
-    EXL_ASSERT(g_Heap != nullptr);
-    return g_Heap->tryAlloc(size, align);
+    return AllocFromThreadHeap(size, align);
 }
 
 void Free(void* address, void* userData) {
-    EXL_ASSERT(g_Heap != nullptr);
-    g_Heap->free(address);
+    FreeToHeap(address);
 }
 
 void* Realloc(void* address, size_t size, void* userData) {
-    EXL_ASSERT(g_Heap != nullptr);
-    return g_Heap->tryRealloc(address, size, 8);
+    return ReallocFromThreadHeap(address, size);
 }
 
 void GlslcInitialize() {
@@ -0,0 +1,251 @@
+#include "diagnostics.hpp"
+#include "file.hpp"
+#include "heap.hpp"
+
+#include <cstring>
+#include <iterator>
+#include <strings.h>
+
+#include <nn/os/impl/os_tick_manager_impl.os.horizon.hpp>
+
+#include "lib.hpp"
+#include "loggers.hpp"
+
+namespace {
+
+constexpr const char* sSeverityNames[] = {
+    "note", "warning", "error",
+};
+
+// counts the output size when given a null buffer, so the same code can size the allocation and then fill it
+class JsonWriter {
+public:
+    JsonWriter(char* buffer, size_t capacity) : m_Buffer(buffer), m_Capacity(capacity) {}
+
+    void Append(const char* data, size_t size) {
+        if (m_Buffer != nullptr && m_Size + size <= m_Capacity) {
+            std::memcpy(m_Buffer + m_Size, data, size);
+        }
+        m_Size += size;
+    }
+
+    void Append(const char* string) {
+        Append(string, strlen(string));
+    }
+
+    void AppendNumber(s64 value) {
+        char buffer[0x20];
+        const s32 size = nn::util::SNPrintf(buffer, sizeof(buffer), "%ld", value);
+        Append(buffer, size);
+    }
+
+    void AppendString(const char* string, size_t size) {
+        Append("\"", 1);
+        for (size_t i = 0; i < size; ++i) {
+            const char c = string[i];
+            if (c == '"' || c == '\\') {
+                const char escaped[] = { '\\', c };
+                Append(escaped, sizeof(escaped));
+            } else if (c == '\n') {
+                Append("\\n", 2);
+            } else if (c == '\t') {
+                Append("\\t", 2);
+            } else if (static_cast<u8>(c) < 0x20) {
+                char escaped[8];
+                const s32 escapedSize = nn::util::SNPrintf(escaped, sizeof(escaped), "\\u%04x", static_cast<u32>(c));
+                Append(escaped, escapedSize);
+            } else {
+                Append(&c, 1);
+            }
+        }
+        Append("\"", 1);
+    }
+
+    void AppendString(const char* string) {
+        AppendString(string, string != nullptr ? strlen(string) : 0);
+    }
+
+    size_t GetSize() const {
+        return m_Size;
+    }
+
+private:
+    char* m_Buffer;
+    size_t m_Capacity;
+    size_t m_Size = 0;
+};
+
+bool ParseNumber(const char*& cursor, const char* end, s32* out) {
+    const char* start = cursor;
+    s32 value = 0;
+    while (cursor < end && *cursor >= '0' && *cursor <= '9') {
+        value = value * 10 + (*cursor - '0');
+        ++cursor;
+    }
+    *out = value;
+    return cursor != start;
+}
+
+bool Consume(const char*& cursor, const char* end, char c) {
+    if (cursor < end && *cursor == c) {
+        ++cursor;
+        return true;
+    }
+    return false;
+}
+
+void SkipSpaces(const char*& cursor, const char* end) {
+    while (cursor < end && *cursor == ' ') {
+        ++cursor;
+    }
+}
+
+bool ParseSeverity(const char*& cursor, const char* end, DiagnosticSeverity* out) {
+    for (size_t i = 0; i < std::size(sSeverityNames); ++i) {
+        const size_t size = strlen(sSeverityNames[i]);
+        if (static_cast<size_t>(end - cursor) >= size && strncasecmp(cursor, sSeverityNames[i], size) == 0) {
+            cursor += size;
+            *out = static_cast<DiagnosticSeverity>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+u64 TicksToMicroseconds(u64 ticks) {
+    return ticks * 1000000 / nn::os::detail::TickManagerImpl::GetTickFrequency();
+}
+
+void WriteResult(JsonWriter& writer, const char* const* inputPaths, s32 inputCount, const char* reason,
+                 const GLSLCcompilationStatus* status, const CompileTiming& timing) {
+    writer.Append("{\n  \"status\": \"failed\",\n  \"reason\": ");
+    writer.AppendString(reason);
+    writer.Append(",\n  \"read_us\": ");
+    writer.AppendNumber(TicksToMicroseconds(timing.readTicks));
+    writer.Append(",\n  \"compile_us\": ");
+    writer.AppendNumber(TicksToMicroseconds(timing.compileTicks));
+
+    const char* infoLog = nullptr;
+    size_t infoLogLength = 0;
+    if (status != nullptr && status->infoLog != nullptr) {
+        infoLog = status->infoLog;
+        infoLogLength = strnlen(infoLog, status->infoLogLength);
+    }
+
+    writer.Append(",\n  \"alloc_error\": ");
+    writer.Append(status != nullptr && status->allocError ? "true" : "false");
+
+    writer.Append(",\n  \"diagnostics\": [");
+    bool first = true;
+    const char* end = infoLog + infoLogLength;
+    for (const char* line = infoLog; line < end;) {
+        const char* lineEnd = static_cast<const char*>(std::memchr(line, '\n', end - line));
+        if (lineEnd == nullptr) {
+            lineEnd = end;
+        }
+        const char* next = lineEnd + 1;
+        while (lineEnd > line && (lineEnd[-1] == '\r' || lineEnd[-1] == ' ')) {
+            --lineEnd;
+        }
+
+        if (lineEnd != line) {
+            const Diagnostic diagnostic = ParseDiagnostic(line, lineEnd - line);
+            writer.Append(first ? "\n    {\"file\": " : ",\n    {\"file\": ");
+            first = false;
+            if (diagnostic.sourceIndex >= 0 && diagnostic.sourceIndex < inputCount) {
+                writer.AppendString(inputPaths[diagnostic.sourceIndex]);
+            } else {
+                writer.Append("null");
+            }
+            writer.Append(", \"line\": ");
+            writer.AppendNumber(diagnostic.line);
+            writer.Append(", \"severity\": ");
+            writer.AppendString(sSeverityNames[static_cast<u8>(diagnostic.severity)]);
+            writer.Append(", \"message\": ");
+            writer.AppendString(diagnostic.message, diagnostic.messageLength);
+            writer.Append("}");
+        }
+        line = next;
+    }
+    writer.Append(first ? "],\n  \"info_log\": " : "\n  ],\n  \"info_log\": ");
+    writer.AppendString(infoLog, infoLogLength);
+    writer.Append("\n}\n");
+}
+
+} // namespace
+
+Diagnostic ParseDiagnostic(const char* line, size_t lineLength) {
+    const char* const end = line + lineLength;
+    Diagnostic diagnostic = {
+        .severity = DiagnosticSeverity::Note,
+        .sourceIndex = -1,
+        .line = -1,
+        .message = line,
+        .messageLength = lineLength,
+    };
+
+    // NVIDIA style: "0(12) : error C1008: undefined variable"
+    const char* cursor = line;
+    s32 sourceIndex, lineNumber;
+    DiagnosticSeverity severity;
+    if (ParseNumber(cursor, end, &sourceIndex) && Consume(cursor, end, '(') && ParseNumber(cursor, end, &lineNumber) &&
+        Consume(cursor, end, ')')) {
+        SkipSpaces(cursor, end);
+        if (Consume(cursor, end, ':')) {
+            SkipSpaces(cursor, end);
+            if (ParseSeverity(cursor, end, &severity)) {
+                SkipSpaces(cursor, end);
+                diagnostic = { severity, sourceIndex, lineNumber, cursor, static_cast<size_t>(end - cursor) };
+                return diagnostic;
+            }
+        }
+    }
+
+    // glslang style: "ERROR: 0:12: 'x' : undeclared identifier"
+    cursor = line;
+    if (ParseSeverity(cursor, end, &severity) && Consume(cursor, end, ':')) {
+        SkipSpaces(cursor, end);
+        const char* message = cursor;
+        if (ParseNumber(cursor, end, &sourceIndex) && Consume(cursor, end, ':') && ParseNumber(cursor, end, &lineNumber) &&
+            Consume(cursor, end, ':')) {
+            SkipSpaces(cursor, end);
+            diagnostic = { severity, sourceIndex, lineNumber, cursor, static_cast<size_t>(end - cursor) };
+        } else {
+            diagnostic = { severity, -1, -1, message, static_cast<size_t>(end - message) };
+        }
+    }
+
+    return diagnostic;
+}
+
+bool PublishFailure(const char* const* outputPaths, s32 outputCount, const char* const* inputPaths, s32 inputCount,
+                    const char* reason, const GLSLCcompilationStatus* status, const CompileTiming& timing) {
+    EXL_ASSERT(outputPaths != nullptr && outputCount > 0);
+
+    JsonWriter sizer(nullptr, 0);
+    WriteResult(sizer, inputPaths, inputCount, reason, status, timing);
+
+    char* buffer = static_cast<char*>(AllocFromHeap(HeapId_Io, sizer.GetSize(), 8));
+    if (buffer == nullptr) {
+        Logging.Log("Failed to allocate 0x%zx bytes for diagnostics", sizer.GetSize());
+        return false;
+    }
+
+    JsonWriter writer(buffer, sizer.GetSize());
+    WriteResult(writer, inputPaths, inputCount, reason, status, timing);
+
+    bool res = true;
+    for (s32 i = 0; i < outputCount; ++i) {
+        if (outputPaths[i] == nullptr) {
+            continue;
+        }
+
+        char path[nn::fs::MaxDirectoryEntryNameSize + 1];
+        nn::util::SNPrintf(path, sizeof(path), "%s%s", outputPaths[i], cDiagnosticsExtension);
+        res = WriteFileAtomic(path, buffer, writer.GetSize()) && res;
+        res = WriteCompletionMarker(outputPaths[i], false) && res;
+    }
+
+    FreeToHeap(buffer);
+    return res;
+}
\ No newline at end of file
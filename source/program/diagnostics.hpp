@@ -0,0 +1,38 @@
+#pragma once
+
+#include <nvnTool/nvnTool_GlslcInterface.h>
+
+#include "nn.hpp"
+
+// failed compiles publish this next to their outputs so clients can stop waiting on binaries that will never appear
+inline constexpr const char* cDiagnosticsExtension = ".diagnostics";
+
+enum class DiagnosticSeverity : u8 {
+    Note,
+    Warning,
+    Error,
+};
+
+// a single record parsed out of glslc's info log
+struct Diagnostic {
+    DiagnosticSeverity severity;
+    // index into the sources passed to Compile, -1 if the record doesn't name one
+    s32 sourceIndex;
+    s32 line;
+    // points into the info log, not null terminated
+    const char* message;
+    size_t messageLength;
+};
+
+struct CompileTiming {
+    u64 readTicks;
+    u64 compileTicks;
+};
+
+// parses a single info log line, lines that don't follow a known format are returned as notes
+Diagnostic ParseDiagnostic(const char* line, size_t lineLength);
+
+// writes a <output><cDiagnosticsExtension> file and a failed completion marker for every output,
+// status may be null if the compiler never ran
+bool PublishFailure(const char* const* outputPaths, s32 outputCount, const char* const* inputPaths, s32 inputCount,
+                    const char* reason, const GLSLCcompilationStatus* status, const CompileTiming& timing);
\ No newline at end of file
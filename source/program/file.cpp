@@ -1,6 +1,8 @@
 #include "file.hpp"
 #include "loggers.hpp"
 
+#include <atomic>
+
 #define ASSERT_RETURN(result, ret, close)           \
     if (result != 0) {                              \
         Logging.Log("Error result for " #result);   \
@@ -9,7 +11,7 @@
         return ret;                                 \
     }
 
-void* ReadFile(const char* path, sead::Heap* heap, long* fileSizeOut) {
+void* ReadFile(const char* path, HeapId heap, long* fileSizeOut) {
     nn::fs::FileHandle handle{};
     ASSERT_RETURN(nn::fs::OpenFile(&handle, path, nn::fs::OpenMode_Read), nullptr, false)
 
@@ -17,14 +19,17 @@ void* ReadFile(const char* path, sead::Heap* heap, long* fileSizeOut) {
     ASSERT_RETURN(nn::fs::GetFileSize(&fileSize, handle), nullptr, true)
 
     // assuming these are text files so we add a null terminator
-    char* buffer = static_cast<char*>(heap->tryAlloc(fileSize + 1, 8));
+    char* buffer = static_cast<char*>(AllocFromHeap(heap, fileSize + 1, 8));
     if (buffer == nullptr) {
+        Logging.Log("Failed to allocate 0x%lx bytes for %s", fileSize + 1, path);
+        nn::fs::CloseFile(handle);
         return nullptr;
     }
 
     if (nn::fs::ReadFile(handle, 0, buffer, fileSize)) {
         Logging.Log("Failed to read file %s", path);
-        heap->free(buffer);
+        nn::fs::CloseFile(handle);
+        FreeToHeap(buffer);
         return nullptr;
     }
 
@@ -53,4 +58,34 @@ bool WriteFile(const char* path, const void* data, size_t size) {
     nn::fs::CloseFile(handle);
 
     return true;
+}
+
+bool WriteFileAtomic(const char* path, const void* data, size_t size) {
+    char tempPath[nn::fs::MaxDirectoryEntryNameSize + 1];
+    nn::util::SNPrintf(tempPath, sizeof(tempPath), "%s.tmp", path);
+    if (!WriteFile(tempPath, data, size)) {
+        return false;
+    }
+
+    // RenameFile doesn't replace existing files
+    nn::fs::DeleteFile(path);
+    if (nn::fs::RenameFile(tempPath, path)) {
+        Logging.Log("Failed to rename %s to %s", tempPath, path);
+        nn::fs::DeleteFile(tempPath);
+        return false;
+    }
+
+    return true;
+}
+
+bool WriteCompletionMarker(const char* outputPath, bool success) {
+    static std::atomic<u64> sSequence = 0;
+
+    char markerPath[nn::fs::MaxDirectoryEntryNameSize + 1];
+    nn::util::SNPrintf(markerPath, sizeof(markerPath), "%s%s", outputPath, cCompletionExtension);
+
+    char marker[0x20];
+    const s32 markerSize = nn::util::SNPrintf(marker, sizeof(marker), "%lu %s\n", sSequence.fetch_add(1, std::memory_order_relaxed) + 1,
+                                              success ? "ok" : "failed");
+    return WriteFileAtomic(markerPath, marker, markerSize);
 }
\ No newline at end of file
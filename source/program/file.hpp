@@ -1,8 +1,15 @@
 #pragma once
 
-#include <heap/seadHeap.h>
-
+#include "heap.hpp"
 #include "nn.hpp"
 
-void* ReadFile(const char* path, sead::Heap* heap, long* fileSizeOut = nullptr);
-bool WriteFile(const char* path, const void* data, size_t size);
\ No newline at end of file
+void* ReadFile(const char* path, HeapId heap, long* fileSizeOut = nullptr);
+bool WriteFile(const char* path, const void* data, size_t size);
+
+// written last for every job, clients wait on this instead of polling each output
+inline constexpr const char* cCompletionExtension = ".done";
+
+// writes to a temporary name and renames it into place so readers never observe a partially written file
+bool WriteFileAtomic(const char* path, const void* data, size_t size);
+// publishes "<sequence> ok|failed" to <outputPath><cCompletionExtension>, the sequence increases with every published job
+bool WriteCompletionMarker(const char* outputPath, bool success);
\ No newline at end of file
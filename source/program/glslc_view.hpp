@@ -0,0 +1,227 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+#include <nvnTool/nvnTool_GlslcInterface.h>
+
+#include "types.h"
+
+// non-owning views over glslc's output, every accessor is bounds checked against the blob and nothing is copied
+// only depends on the glslc interface header so it can be built on the host as well
+
+class ByteView {
+public:
+    constexpr ByteView() = default;
+    constexpr ByteView(const void* data, size_t size) : m_Data(static_cast<const u8*>(data)), m_Size(data != nullptr ? size : 0) {}
+
+    constexpr const u8* GetData() const {
+        return m_Data;
+    }
+
+    constexpr size_t GetSize() const {
+        return m_Size;
+    }
+
+    constexpr bool IsEmpty() const {
+        return m_Size == 0;
+    }
+
+    constexpr bool Contains(size_t offset, size_t size) const {
+        return offset <= m_Size && size <= m_Size - offset;
+    }
+
+    // empty if the range isn't fully contained
+    constexpr ByteView Slice(size_t offset, size_t size) const {
+        return Contains(offset, size) ? ByteView(m_Data + offset, size) : ByteView();
+    }
+
+    constexpr ByteView Slice(size_t offset) const {
+        return offset <= m_Size ? ByteView(m_Data + offset, m_Size - offset) : ByteView();
+    }
+
+    // the data has no alignment guarantees, so values are copied out instead of dereferenced in place
+    template<typename T>
+    bool Read(T* out, size_t offset) const {
+        static_assert(std::is_trivially_copyable_v<T>);
+        if (!Contains(offset, sizeof(T))) {
+            return false;
+        }
+        std::memcpy(out, m_Data + offset, sizeof(T));
+        return true;
+    }
+
+private:
+    const u8* m_Data = nullptr;
+    size_t m_Size = 0;
+};
+
+// fields of the control section that locate the shader and its constants within the code section
+class ControlSectionView {
+public:
+    static constexpr const size_t ShaderSizeOffset = 0x6f8;
+    static constexpr const size_t ConstbufSizeOffset = 0x6fc;
+    static constexpr const size_t ConstbufOffsetOffset = 0x700;
+    static constexpr const size_t ShaderOffsetOffset = 0x708;
+    static constexpr const size_t StageOffset = 0x714;
+    static constexpr const size_t MinimumSize = StageOffset + sizeof(u32);
+
+    constexpr ControlSectionView() = default;
+    explicit constexpr ControlSectionView(ByteView data) : m_Data(data) {}
+
+    constexpr bool IsValid() const {
+        return m_Data.GetSize() >= MinimumSize;
+    }
+
+    constexpr ByteView GetData() const {
+        return m_Data;
+    }
+
+    u32 GetShaderSize() const {
+        return ReadWord(ShaderSizeOffset);
+    }
+
+    u32 GetShaderOffset() const {
+        return ReadWord(ShaderOffsetOffset);
+    }
+
+    u32 GetConstbufSize() const {
+        return ReadWord(ConstbufSizeOffset);
+    }
+
+    u32 GetConstbufOffset() const {
+        return ReadWord(ConstbufOffsetOffset);
+    }
+
+    NVNshaderStage GetStage() const {
+        return static_cast<NVNshaderStage>(ReadWord(StageOffset));
+    }
+
+private:
+    // reads as zero when out of bounds, callers are expected to check IsValid
+    u32 ReadWord(size_t offset) const {
+        u32 value = 0;
+        m_Data.Read(&value, offset);
+        return value;
+    }
+
+    ByteView m_Data;
+};
+
+class GpuCodeView {
+public:
+    // compute shaders don't have the shader program header
+    static constexpr const size_t ShaderProgramHeaderSize = 0x50;
+
+    constexpr GpuCodeView() = default;
+    constexpr GpuCodeView(const GLSLCgpuCodeHeader* header, ByteView control, ByteView code) : m_Header(header), m_Control(control), m_Code(code) {}
+
+    constexpr bool IsValid() const {
+        return m_Header != nullptr && ControlSectionView(m_Control).IsValid();
+    }
+
+    constexpr const GLSLCgpuCodeHeader* GetHeader() const {
+        return m_Header;
+    }
+
+    constexpr NVNshaderStage GetStage() const {
+        return m_Header != nullptr ? m_Header->stage : NVN_SHADER_STAGE_LARGE;
+    }
+
+    constexpr ByteView GetControl() const {
+        return m_Control;
+    }
+
+    constexpr ByteView GetCode() const {
+        return m_Code;
+    }
+
+    constexpr ControlSectionView GetControlSection() const {
+        return ControlSectionView(m_Control);
+    }
+
+    // the shader including its program header, empty if the control section points out of bounds
+    ByteView GetShader() const {
+        const ControlSectionView control = GetControlSection();
+        return control.IsValid() ? m_Code.Slice(control.GetShaderOffset(), control.GetShaderSize()) : ByteView();
+    }
+
+    // the shader code only
+    ByteView GetShaderCode() const {
+        const ByteView shader = GetShader();
+        return GetStage() == NVN_SHADER_STAGE_COMPUTE ? shader : shader.Slice(ShaderProgramHeaderSize);
+    }
+
+    // empty if the shader has no constants
+    ByteView GetConstbuf() const {
+        const ControlSectionView control = GetControlSection();
+        return control.IsValid() ? m_Code.Slice(control.GetConstbufOffset(), control.GetConstbufSize()) : ByteView();
+    }
+
+private:
+    const GLSLCgpuCodeHeader* m_Header = nullptr;
+    ByteView m_Control;
+    ByteView m_Code;
+};
+
+class GlslcOutputView {
+public:
+    constexpr GlslcOutputView() = default;
+    constexpr GlslcOutputView(const void* data, size_t size) : m_Data(data, size) {}
+    // glslc records the size of the whole blob in the output itself
+    explicit GlslcOutputView(const GLSLCoutput* output) : m_Data(output, output != nullptr ? output->size : 0) {}
+
+    bool IsValid() const {
+        u32 sectionCount;
+        return m_Data.Read(&sectionCount, offsetof(GLSLCoutput, numSections)) &&
+               m_Data.Contains(offsetof(GLSLCoutput, headers), static_cast<size_t>(sectionCount) * sizeof(GLSLCsectionHeaderUnion));
+    }
+
+    u32 GetSectionCount() const {
+        return IsValid() ? GetOutput()->numSections : 0;
+    }
+
+    const GLSLCsectionHeaderUnion* GetSectionHeader(u32 index) const {
+        return index < GetSectionCount() ? &GetOutput()->headers[index] : nullptr;
+    }
+
+    GLSLCsectionTypeEnum GetSectionType(u32 index) const {
+        const GLSLCsectionHeaderUnion* header = GetSectionHeader(index);
+        return header != nullptr ? header->genericHeader.common.type : GLSLC_SECTION_TYPE_ENUM_LARGE;
+    }
+
+    // data of a section, bounded by the end of the blob
+    ByteView GetSectionData(u32 index) const {
+        const GLSLCsectionHeaderUnion* header = GetSectionHeader(index);
+        return header != nullptr ? m_Data.Slice(header->genericHeader.common.dataOffset) : ByteView();
+    }
+
+    GpuCodeView GetGpuCode(u32 index) const {
+        if (GetSectionType(index) != GLSLC_SECTION_TYPE_GPU_CODE) {
+            return GpuCodeView();
+        }
+
+        const GLSLCgpuCodeHeader* header = &GetSectionHeader(index)->gpuCodeHeader;
+        const ByteView section = GetSectionData(index);
+        return GpuCodeView(header, section.Slice(header->controlOffset, header->controlSize), section.Slice(header->dataOffset, header->dataSize));
+    }
+
+    // NVN_SHADER_STAGE_LARGE matches the first GPU code section
+    GpuCodeView FindGpuCode(NVNshaderStage stage) const {
+        for (u32 i = 0; i < GetSectionCount(); ++i) {
+            const GpuCodeView gpuCode = GetGpuCode(i);
+            if (gpuCode.GetHeader() != nullptr && (stage == NVN_SHADER_STAGE_LARGE || gpuCode.GetStage() == stage)) {
+                return gpuCode;
+            }
+        }
+        return GpuCodeView();
+    }
+
+private:
+    const GLSLCoutput* GetOutput() const {
+        return reinterpret_cast<const GLSLCoutput*>(m_Data.GetData());
+    }
+
+    ByteView m_Data;
+};
\ No newline at end of file
@@ -0,0 +1,232 @@
+#include "heap.hpp"
+
+#include <atomic>
+#include <cstring>
+#include <mutex>
+
+#include "lib.hpp"
+#include "loggers.hpp"
+
+namespace {
+
+// TLSF arena over a single block carved from the root heap
+class SubHeap {
+public:
+    bool Initialize(sead::Heap* parent, size_t size) {
+        void* start = parent->tryAlloc(size, exl::alloc::Tlsf::Alignment);
+        if (start == nullptr) {
+            return false;
+        }
+
+        if (!m_Arena.Initialize(start, size)) {
+            parent->free(start);
+            return false;
+        }
+        return true;
+    }
+
+    bool IsInitialized() const {
+        return m_Arena.IsInitialized();
+    }
+
+    bool IsInclude(const void* address) const {
+        return m_Arena.Contains(address);
+    }
+
+    void* Alloc(size_t size, size_t align) {
+        std::scoped_lock lock(m_Mutex);
+        return m_Arena.Allocate(size, align);
+    }
+
+    void Free(void* address) {
+        std::scoped_lock lock(m_Mutex);
+        m_Arena.Free(address);
+    }
+
+    void* Realloc(void* address, size_t size) {
+        std::scoped_lock lock(m_Mutex);
+        return m_Arena.Reallocate(address, size);
+    }
+
+    size_t GetAllocatedSize(const void* address) const {
+        return m_Arena.GetAllocationSize(address);
+    }
+
+    HeapStats GetStats() {
+        std::scoped_lock lock(m_Mutex);
+        const exl::alloc::TlsfStats& stats = m_Arena.GetStats();
+        return HeapStats {
+            .size = stats.m_ArenaSize,
+            .usedSize = stats.m_UsedSize,
+            .peakUsedSize = stats.m_PeakUsedSize,
+            .allocCount = stats.m_AllocCount,
+            .freeCount = stats.m_FreeCount,
+            .failCount = stats.m_FailCount,
+        };
+    }
+
+private:
+    exl::alloc::Tlsf m_Arena;
+    nn::os::Mutex m_Mutex{false};
+};
+
+constinit SubHeap sSubHeaps[HeapId_Count];
+sead::Heap* sRootHeap = nullptr;
+nn::os::TlsSlot sThreadHeapSlot{};
+
+std::atomic<u64> sRootAllocCount = 0;
+std::atomic<u64> sRootFreeCount = 0;
+std::atomic<u64> sRootFailCount = 0;
+
+constexpr const char* sHeapNames[] = {
+    "Io", "Worker0", "Worker1", "Worker2",
+};
+static_assert(std::size(sHeapNames) == HeapId_Count);
+
+SubHeap* GetSubHeap(HeapId id) {
+    if (id < 0 || id >= HeapId_Count || !sSubHeaps[id].IsInitialized()) {
+        return nullptr;
+    }
+    return &sSubHeaps[id];
+}
+
+SubHeap* FindOwner(const void* address) {
+    for (auto& heap : sSubHeaps) {
+        if (heap.IsInitialized() && heap.IsInclude(address)) {
+            return &heap;
+        }
+    }
+    return nullptr;
+}
+
+void* AllocFromRoot(size_t size, size_t align) {
+    void* ptr = sRootHeap->tryAlloc(size, static_cast<s32>(align));
+    if (ptr != nullptr) {
+        sRootAllocCount.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        sRootFailCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    return ptr;
+}
+
+} // namespace
+
+void InitializeHeaps(sead::Heap* rootHeap, s32 workerCount) {
+    EXL_ASSERT(rootHeap != nullptr);
+    EXL_ASSERT(workerCount >= 0 && workerCount <= cMaxWorkerHeapCount);
+    sRootHeap = rootHeap;
+
+    EXL_ABORT_UNLESS(nn::os::AllocateTlsSlot(&sThreadHeapSlot, nullptr) == 0);
+
+    // heaps of workers that don't exist would only take memory away from the root heap
+    for (s32 i = 0; i < HeapId_Worker0 + workerCount; ++i) {
+        const size_t size = i == HeapId_Io ? cIoHeapSize : cWorkerHeapSize;
+        if (!sSubHeaps[i].Initialize(rootHeap, size)) {
+            Logging.Log("Failed to carve %s heap (0x%zx bytes), falling back to root heap", sHeapNames[i], size);
+        }
+    }
+}
+
+void BindThreadHeap(HeapId id) {
+    // stored offset by one so that threads which were never bound read back as the root heap
+    nn::os::SetTlsValue(sThreadHeapSlot, static_cast<uintptr_t>(id + 1));
+}
+
+HeapId GetThreadHeapId() {
+    return static_cast<HeapId>(static_cast<s32>(nn::os::GetTlsValue(sThreadHeapSlot)) - 1);
+}
+
+void* AllocFromHeap(HeapId id, size_t size, size_t align) {
+    EXL_ASSERT(sRootHeap != nullptr);
+    SubHeap* heap = GetSubHeap(id);
+    if (heap != nullptr) {
+        if (void* ptr = heap->Alloc(size, align); ptr != nullptr) {
+            return ptr;
+        }
+    }
+    // the root heap doubles as the fallback when a sub-heap is exhausted
+    return AllocFromRoot(size, align);
+}
+
+void* AllocFromThreadHeap(size_t size, size_t align) {
+    return AllocFromHeap(GetThreadHeapId(), size, align);
+}
+
+void FreeToHeap(void* address) {
+    EXL_ASSERT(sRootHeap != nullptr);
+    if (address == nullptr) {
+        return;
+    }
+
+    SubHeap* heap = FindOwner(address);
+    if (heap == nullptr) {
+        sRootFreeCount.fetch_add(1, std::memory_order_relaxed);
+        sRootHeap->free(address);
+        return;
+    }
+    heap->Free(address);
+}
+
+void* ReallocFromThreadHeap(void* address, size_t size) {
+    EXL_ASSERT(sRootHeap != nullptr);
+    if (address == nullptr) {
+        return AllocFromThreadHeap(size, 8);
+    }
+    if (size == 0) {
+        FreeToHeap(address);
+        return nullptr;
+    }
+
+    SubHeap* heap = FindOwner(address);
+    if (heap == nullptr) {
+        return sRootHeap->tryRealloc(address, size, 8);
+    }
+
+    // keep the reallocated block in the heap that owned the original allocation if it fits
+    if (void* newAddress = heap->Realloc(address, size); newAddress != nullptr) {
+        return newAddress;
+    }
+
+    void* newAddress = AllocFromRoot(size, 8);
+    if (newAddress == nullptr) {
+        return nullptr;
+    }
+    const size_t oldSize = heap->GetAllocatedSize(address);
+    std::memcpy(newAddress, address, oldSize < size ? oldSize : size);
+    heap->Free(address);
+    return newAddress;
+}
+
+void GetHeapStats(HeapStats* statsOut, HeapId id) {
+    EXL_ASSERT(statsOut != nullptr);
+    SubHeap* heap = GetSubHeap(id);
+    if (heap != nullptr) {
+        *statsOut = heap->GetStats();
+        return;
+    }
+
+    *statsOut = {};
+    if (id == HeapId_Root && sRootHeap != nullptr) {
+        statsOut->size = sRootHeap->getSize();
+        statsOut->usedSize = statsOut->size - sRootHeap->getFreeSize();
+        statsOut->allocCount = sRootAllocCount.load(std::memory_order_relaxed);
+        statsOut->freeCount = sRootFreeCount.load(std::memory_order_relaxed);
+        statsOut->failCount = sRootFailCount.load(std::memory_order_relaxed);
+    }
+}
+
+void LogHeapStats() {
+    HeapStats stats{};
+    GetHeapStats(&stats, HeapId_Root);
+    Logging.Log("Heap Root: used 0x%zx/0x%zx, %lu allocs, %lu frees, %lu failed",
+                stats.usedSize, stats.size, stats.allocCount, stats.freeCount, stats.failCount);
+
+    for (s32 i = 0; i < HeapId_Count; ++i) {
+        if (GetSubHeap(static_cast<HeapId>(i)) == nullptr) {
+            continue;
+        }
+        GetHeapStats(&stats, static_cast<HeapId>(i));
+        Logging.Log("Heap %s: used 0x%zx/0x%zx (peak 0x%zx), %lu allocs, %lu frees, %lu failed",
+                    sHeapNames[i], stats.usedSize, stats.size, stats.peakUsedSize, stats.allocCount, stats.freeCount, stats.failCount);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <heap/seadHeap.h>
+
+#include "nn.hpp"
+
+// sub-heaps carved out of the application root heap so that threads don't all contend on the root heap's lock
+enum HeapId : s32 {
+    HeapId_Io,
+    HeapId_Worker0,
+    HeapId_Worker1,
+    HeapId_Worker2,
+
+    HeapId_Count,
+    HeapId_Root = -1,
+};
+
+inline constexpr const s32 cMaxWorkerHeapCount = HeapId_Count - HeapId_Worker0;
+inline constexpr const size_t cIoHeapSize = 0x1000000;
+inline constexpr const size_t cWorkerHeapSize = 0x4000000;
+
+struct HeapStats {
+    size_t size;
+    size_t usedSize;
+    size_t peakUsedSize;
+    u64 allocCount;
+    u64 freeCount;
+    u64 failCount;
+};
+
+// carves the I/O heap and one heap per worker thread out of the root heap, any sub-heap that isn't carved falls back to the root heap
+void InitializeHeaps(sead::Heap* rootHeap, s32 workerCount);
+
+// binds the calling thread to a heap, allocations made with AllocFromThreadHeap on this thread will be routed there
+void BindThreadHeap(HeapId id);
+HeapId GetThreadHeapId();
+
+void* AllocFromHeap(HeapId id, size_t size, size_t align);
+void* AllocFromThreadHeap(size_t size, size_t align);
+// frees to whichever heap owns the address
+void FreeToHeap(void* address);
+void* ReallocFromThreadHeap(void* address, size_t size);
+
+void GetHeapStats(HeapStats* statsOut, HeapId id);
+void LogHeapStats();
\ No newline at end of file
@@ -1,10 +1,13 @@
 #pragma once
 
+#include <lib/log/async_logger.hpp>
+#include <lib/log/file_logger.hpp>
 #include <lib/log/svc_logger.hpp>
 
 #include "lib.hpp"
 
 /* Specify logger implementations here. */
 inline exl::log::LoggerMgr<
-    exl::log::SvcLogger
+    exl::log::AsyncLogger<exl::log::SvcLogger>,
+    exl::log::AsyncLogger<exl::log::FileLogger>
 > Logging;
\ No newline at end of file
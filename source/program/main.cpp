@@ -1,5 +1,10 @@
 #include "compile.hpp"
+#include "diagnostics.hpp"
 #include "file.hpp"
+#include "glslc_view.hpp"
+#include "heap.hpp"
+
+#include <algorithm>
 
 #include "lib.hpp"
 #include "nn.hpp"
@@ -8,6 +13,15 @@ static constexpr const char* sShaderExtensions[] = {
     ".vert", ".frag", ".geom", ".tesc", ".tese", ".comp",
 };
 
+// derived outputs a job can request by writing e.g. "nv raw" to <input><cOutputFormatsExtension> before the input itself
+enum OutputFormat : u32 {
+    OutputFormat_Nv = 1 << 0,       // shader code including the shader program header
+    OutputFormat_Raw = 1 << 1,      // shader code only
+    OutputFormat_Constbuf = 1 << 2, // shader constants buffer
+};
+
+static constexpr const char* cOutputFormatsExtension = ".formats";
+
 static bool EndsWith(const char* str, const char* suffix) {
     if (str == nullptr || suffix == nullptr) {
         return false;
@@ -27,35 +41,122 @@ static void Concat(char* buffer, size_t bufferSize, const char* basePath, const
     buffer[size] = '\0';
 }
 
-static bool OutputShaderBinary(const GLSLCoutput* glslcOutput, const char* outputPath, NVNshaderStage stage) {
-    for (u32 i = 0; i < glslcOutput->numSections; ++i) {
-        if (glslcOutput->headers[i].genericHeader.common.type != GLSLC_SECTION_TYPE_GPU_CODE) {
-            continue;
+static u32 ReadOutputFormats(const char* inputPath) {
+    char formatsPath[nn::fs::MaxDirectoryEntryNameSize + 1];
+    Concat(formatsPath, sizeof(formatsPath), inputPath, cOutputFormatsExtension);
+
+    nn::fs::FileHandle handle{};
+    if (nn::fs::OpenFile(&handle, formatsPath, nn::fs::OpenMode_Read)) {
+        return 0;
+    }
+
+    char buffer[0x40] = {};
+    long size = 0;
+    // leave room for the null terminator, longer requests than this aren't meaningful anyways
+    const bool success = nn::fs::GetFileSize(&size, handle) == 0 && size > 0 &&
+                         nn::fs::ReadFile(handle, 0, buffer, std::min<long>(size, sizeof(buffer) - 1)) == 0;
+    nn::fs::CloseFile(handle);
+    if (!success) {
+        Logging.Log("Failed to read %s", formatsPath);
+        return 0;
+    }
+
+    u32 formats = 0;
+    char* context = nullptr;
+    for (const char* token = strtok_r(buffer, " ,\t\r\n", &context); token != nullptr; token = strtok_r(nullptr, " ,\t\r\n", &context)) {
+        if (strcmp(token, "nv") == 0) {
+            formats |= OutputFormat_Nv;
+        } else if (strcmp(token, "raw") == 0) {
+            formats |= OutputFormat_Raw;
+        } else if (strcmp(token, "constbuf") == 0) {
+            formats |= OutputFormat_Constbuf;
+        } else {
+            Logging.Log("Unknown output format %s in %s", token, formatsPath);
         }
+    }
+    return formats;
+}
 
-        // if we don't know the stage, then just output the first binary
-        if (stage != NVN_SHADER_STAGE_LARGE && glslcOutput->headers[i].gpuCodeHeader.stage != stage) {
-            continue;
+// slices the derived formats out of the code section while it's still in memory, instead of the client re-reading the outputs
+static bool OutputDerivedFormats(const GpuCodeView& gpuCode, const char* outputPath, u32 formats) {
+    const ControlSectionView control = gpuCode.GetControlSection();
+    if (!control.IsValid()) {
+        Logging.Log("Control section of %s is too small (0x%zx bytes)", outputPath, control.GetData().GetSize());
+        return false;
+    }
+
+    bool res = true;
+    char path[nn::fs::MaxDirectoryEntryNameSize + 1];
+    if (formats & (OutputFormat_Nv | OutputFormat_Raw)) {
+        const ByteView shader = gpuCode.GetShader();
+        if (shader.IsEmpty()) {
+            Logging.Log("Shader of %s is out of bounds (0x%x + 0x%x > 0x%zx)", outputPath, control.GetShaderOffset(), control.GetShaderSize(), gpuCode.GetCode().GetSize());
+            return false;
         }
 
-        const auto* binPtr = reinterpret_cast<const char*>(glslcOutput) + glslcOutput->headers[i].gpuCodeHeader.common.dataOffset;
-    
-        bool res = true;
+        if (formats & OutputFormat_Nv) {
+            Concat(path, sizeof(path), outputPath, ".code.nv");
+            res = WriteFileAtomic(path, shader.GetData(), shader.GetSize()) && res;
+        }
 
-        const char* control = reinterpret_cast<const char*>(binPtr) + glslcOutput->headers[i].gpuCodeHeader.controlOffset;
-        char controlPath[nn::fs::MaxDirectoryEntryNameSize + 1];
-        Concat(controlPath, sizeof(controlPath), outputPath, ".control");
-        res = WriteFile(controlPath, control, glslcOutput->headers[i].gpuCodeHeader.controlSize) && res;
-    
-        const char* code = reinterpret_cast<const char*>(binPtr) + glslcOutput->headers[i].gpuCodeHeader.dataOffset;
-        char codePath[nn::fs::MaxDirectoryEntryNameSize + 1];
-        Concat(codePath, sizeof(codePath), outputPath, ".code");
-        res = WriteFile(codePath, code, glslcOutput->headers[i].gpuCodeHeader.dataSize) && res;
+        if (formats & OutputFormat_Raw) {
+            const ByteView shaderCode = gpuCode.GetShaderCode();
+            if (shaderCode.IsEmpty()) {
+                Logging.Log("Shader of %s is smaller than its program header (0x%zx bytes)", outputPath, shader.GetSize());
+                return false;
+            }
+
+            Concat(path, sizeof(path), outputPath, ".code.raw");
+            res = WriteFileAtomic(path, shaderCode.GetData(), shaderCode.GetSize()) && res;
+        }
+    }
+
+    // shaders without constants don't get a constbuf output
+    if ((formats & OutputFormat_Constbuf) && control.GetConstbufSize() != 0) {
+        const ByteView constbuf = gpuCode.GetConstbuf();
+        if (constbuf.IsEmpty()) {
+            Logging.Log("Constants of %s are out of bounds (0x%x + 0x%x > 0x%zx)", outputPath, control.GetConstbufOffset(), control.GetConstbufSize(), gpuCode.GetCode().GetSize());
+            return false;
+        }
 
-        return res;
+        Concat(path, sizeof(path), outputPath, ".code.constbuf");
+        res = WriteFileAtomic(path, constbuf.GetData(), constbuf.GetSize()) && res;
     }
 
-    return false;
+    return res;
+}
+
+static bool OutputShaderBinary(const GLSLCoutput* glslcOutput, const char* outputPath, NVNshaderStage stage, u32 formats) {
+    // if we don't know the stage, then just output the first binary
+    const GpuCodeView gpuCode = GlslcOutputView(glslcOutput).FindGpuCode(stage);
+    if (gpuCode.GetHeader() == nullptr) {
+        Logging.Log("No GPU code for %s", outputPath);
+        return false;
+    }
+
+    const ByteView control = gpuCode.GetControl();
+    const ByteView code = gpuCode.GetCode();
+    if (control.IsEmpty() || code.IsEmpty()) {
+        Logging.Log("GPU code for %s is out of bounds", outputPath);
+        return false;
+    }
+
+    bool res = true;
+
+    char controlPath[nn::fs::MaxDirectoryEntryNameSize + 1];
+    Concat(controlPath, sizeof(controlPath), outputPath, ".control");
+    res = WriteFileAtomic(controlPath, control.GetData(), control.GetSize()) && res;
+
+    char codePath[nn::fs::MaxDirectoryEntryNameSize + 1];
+    Concat(codePath, sizeof(codePath), outputPath, ".code");
+    res = WriteFileAtomic(codePath, code.GetData(), code.GetSize()) && res;
+
+    if (formats != 0) {
+        res = OutputDerivedFormats(gpuCode, outputPath, formats) && res;
+    }
+
+    // only mark the job as done once everything else is in place
+    return res && WriteCompletionMarker(outputPath, true);
 }
 
 static bool CompileShader(const char* inputPath, const char* outputPath, NVNshaderStage stage = NVN_SHADER_STAGE_LARGE) {
@@ -71,12 +172,15 @@ static bool CompileShader(const char* inputPath, const char* outputPath, NVNshad
         }
     }
 
+    const u64 startTick = svcGetSystemTick();
     long fileSize = 0;
-    char* shaderSource = static_cast<char*>(ReadFile(inputPath, g_Heap, &fileSize));
+    char* shaderSource = static_cast<char*>(ReadFile(inputPath, HeapId_Io, &fileSize));
     if (shaderSource == nullptr) {
         Logging.Log("Failed to read %s", inputPath);
+        PublishFailure(&outputPath, 1, &inputPath, 1, "read", nullptr, {});
         return false;
     }
+    const u64 readTick = svcGetSystemTick();
 
     bool isSpirv;
     u32 moduleSizes[1] = { 0 };
@@ -89,20 +193,28 @@ static bool CompileShader(const char* inputPath, const char* outputPath, NVNshad
 
     if (stage == NVN_SHADER_STAGE_LARGE && !isSpirv) {
         Logging.Log("Failed to determine shader stage for %s", inputPath);
+        PublishFailure(&outputPath, 1, &inputPath, 1, "stage", nullptr, { readTick - startTick, 0 });
+        FreeToHeap(shaderSource);
         return false;
     }
 
     bool res = false;
     const char* sources[] = { shaderSource }; const NVNshaderStage stages[] = { stage };
     auto compileObject = Compile(sources, stages, 1, isSpirv ? moduleSizes : nullptr);
+    const CompileTiming timing = { readTick - startTick, svcGetSystemTick() - readTick };
     if (!compileObject.lastCompiledResults->compilationStatus->success) {
         Logging.Log("Failed to compile %s", inputPath);
+        // publish right away so clients don't have to wait for outputs that will never appear
+        PublishFailure(&outputPath, 1, &inputPath, 1, "compile", compileObject.lastCompiledResults->compilationStatus, timing);
     } else {
-        res = OutputShaderBinary(compileObject.lastCompiledResults->glslcOutput, outputPath, stage);
+        res = OutputShaderBinary(compileObject.lastCompiledResults->glslcOutput, outputPath, stage, ReadOutputFormats(inputPath));
+        if (!res) {
+            PublishFailure(&outputPath, 1, &inputPath, 1, "output", nullptr, timing);
+        }
     }
 
     glslcFinalize(&compileObject);
-    g_Heap->free(shaderSource);
+    FreeToHeap(shaderSource);
     return res;
 }
 
@@ -112,16 +224,20 @@ static bool CompileShader(const char* const* inputPaths, const char* const* outp
 
     char* sources[5] = {};
     NVNshaderStage stages[5] = {};
+    const char* inputs[5] = {};
     const char* outputs[5] = {};
     u32 moduleSizes[5] = {};
     s32 count = 0;
+    s32 failedIndices[5] = {};
+    s32 failedCount = 0;
     bool res = false;
     bool isSpirv = true;
     
+    const u64 startTick = svcGetSystemTick();
     for (s32 i = 0; i < 5; ++i) {
         if (inputPaths[i] != nullptr && outputPaths[i] != nullptr) {
             long fileSize = 0;
-            char* shaderSource = static_cast<char*>(ReadFile(inputPaths[i], g_Heap, &fileSize));
+            char* shaderSource = static_cast<char*>(ReadFile(inputPaths[i], HeapId_Io, &fileSize));
             if (shaderSource != nullptr) {
                 if (fileSize > 0x14 && *reinterpret_cast<u32*>(shaderSource) == cSpirvMagicNumber) {
                     moduleSizes[count] = static_cast<u32>(fileSize);
@@ -129,23 +245,46 @@ static bool CompileShader(const char* const* inputPaths, const char* const* outp
                     isSpirv = false;
                 }
                 sources[count] = shaderSource;
+                inputs[count] = inputPaths[i];
                 outputs[count] = outputPaths[i];
                 stages[count++] = static_cast<NVNshaderStage>(i);
             } else {
                 Logging.Log("Failed to read file %s", inputPaths[i]);
+                failedIndices[failedCount++] = i;
             }
         }
     }
 
+    const u64 readTick = svcGetSystemTick();
+
+    // publish unreadable stages on their own, otherwise their outputs never get a marker and the group is rescanned forever
+    for (s32 i = 0; i < failedCount; ++i) {
+        const s32 index = failedIndices[i];
+        PublishFailure(&outputPaths[index], 1, &inputPaths[index], 1, "read", nullptr, { readTick - startTick, 0 });
+    }
+
+    if (count == 0) {
+        if (failedCount == 0) {
+            PublishFailure(outputPaths, 5, inputPaths, 0, "read", nullptr, { readTick - startTick, 0 });
+        }
+        return false;
+    }
+
     Logging.Log("Compiling...");
     auto compileObject = Compile(sources, stages, count, isSpirv ? moduleSizes : nullptr);
+    const CompileTiming timing = { readTick - startTick, svcGetSystemTick() - readTick };
     if (!compileObject.lastCompiledResults->compilationStatus->success) {
         Logging.Log("Failed to compile shader");
+        PublishFailure(outputs, count, inputs, count, "compile", compileObject.lastCompiledResults->compilationStatus, timing);
     } else {
-        res = true;
+        res = failedCount == 0;
         for (s32 i = 0; i < count; ++i) {
             if (outputs[i] != nullptr) {
-                res = OutputShaderBinary(compileObject.lastCompiledResults->glslcOutput, outputs[i], stages[i]) && res;
+                if (OutputShaderBinary(compileObject.lastCompiledResults->glslcOutput, outputs[i], stages[i], ReadOutputFormats(inputs[i]))) {
+                    continue;
+                }
+                PublishFailure(&outputs[i], 1, &inputs[i], 1, "output", nullptr, timing);
+                res = false;
             }
         }
     }
@@ -153,7 +292,7 @@ static bool CompileShader(const char* const* inputPaths, const char* const* outp
     glslcFinalize(&compileObject);
     for (s32 i = 0; i < 5; ++i) {
         if (sources[i] != nullptr) {
-            g_Heap->free(sources[i]);
+            FreeToHeap(sources[i]);
         }
     }
 
@@ -162,15 +301,13 @@ static bool CompileShader(const char* const* inputPaths, const char* const* outp
 
 HOOK_DEFINE_REPLACE(OperatorNewReplacement) {
     static void* Callback(size_t size) {
-        EXL_ASSERT(g_Heap != nullptr);
-        return g_Heap->tryAlloc(size, 0x10);
+        return AllocFromThreadHeap(size, 0x10);
     }
 };
 
 HOOK_DEFINE_REPLACE(OperatorDeleteReplacement) {
     static void Callback(void* address) {
-        EXL_ASSERT(g_Heap != nullptr);
-        g_Heap->free(address);
+        FreeToHeap(address);
     }
 };
 
@@ -178,12 +315,21 @@ HOOK_DEFINE_INLINE(AppMain) {
     static void Callback(exl::hook::InlineCtx* ctx) {
         // steal application root heap (we're blocking the entire program anyways so it doesn't matter)
         g_Heap = reinterpret_cast<sead::Heap*>(ctx->X[19]);
-        OperatorNewReplacement::InstallAtOffset(0x01062ce0);
-        OperatorDeleteReplacement::InstallAtOffset(0x00cf43d0);
+        // compilation currently happens on this thread only, file buffers are explicitly allocated from the I/O heap
+        InitializeHeaps(g_Heap, 1);
+        BindThreadHeap(HeapId_Worker0);
+        {
+            exl::hook::Transaction transaction;
+            OperatorNewReplacement::InstallAtOffset(0x01062ce0);
+            OperatorDeleteReplacement::InstallAtOffset(0x00cf43d0);
+        }
         GlslcInitialize();
 
+        // the file logger writes to sd:/output, so it has to exist before the drain thread starts
         EXL_ABORT_UNLESS(nn::fs::MountSdCard("sd") == 0);
         nn::fs::CreateDirectory("sd:/output");
+        // nnSdk is usable from here on, so move logging off of the compile thread
+        Logging.StartAsync();
 
         while (true) {
             nn::fs::DirectoryHandle handle{};
@@ -199,6 +345,11 @@ HOOK_DEFINE_INLINE(AppMain) {
                 nn::fs::DirectoryEntry file{};
                 nn::fs::ReadDirectory(&readCount, &file, handle, 1);
 
+                // format requests are picked up along with the shader they belong to
+                if (EndsWith(file.m_Name, cOutputFormatsExtension)) {
+                    continue;
+                }
+
                 if (EndsWith(file.m_Name, ".vert") ||
                     EndsWith(file.m_Name, ".tesc") ||
                     EndsWith(file.m_Name, ".tese") ||
@@ -236,17 +387,11 @@ HOOK_DEFINE_INLINE(AppMain) {
                             inputs[j] = outputs[j] = nullptr;
                             continue;
                         }
-                        char controlPath[nn::fs::MaxDirectoryEntryNameSize + 1];
-                        char codePath[nn::fs::MaxDirectoryEntryNameSize + 1];
-                        Concat(controlPath, sizeof(controlPath), outputs[j], ".control");
-                        Concat(codePath, sizeof(codePath), outputs[j], ".code");
+                        // the completion marker is written last for both binaries and published failures
+                        char markerPath[nn::fs::MaxDirectoryEntryNameSize + 1];
+                        Concat(markerPath, sizeof(markerPath), outputs[j], cCompletionExtension);
                         nn::fs::FileHandle outputHandle{};
-                        if (nn::fs::OpenFile(&outputHandle, controlPath, nn::fs::OpenMode_Read) == 0) {
-                            nn::fs::CloseFile(outputHandle);
-                        } else {
-                            allExists = false;
-                        }
-                        if (nn::fs::OpenFile(&outputHandle, codePath, nn::fs::OpenMode_Read) == 0) {
+                        if (nn::fs::OpenFile(&outputHandle, markerPath, nn::fs::OpenMode_Read) == 0) {
                             nn::fs::CloseFile(outputHandle);
                         } else {
                             allExists = false;
@@ -257,11 +402,11 @@ HOOK_DEFINE_INLINE(AppMain) {
                         continue;
                     }
 
-                    Logging.Log("Compiling %s", file.m_Name);
+                    Logging.LogDeferred<exl::log::Level::Info>("Compiling %s", file.m_Name);
                     if (CompileShader(inputs, outputs)) {
-                        Logging.Log("Saved %s and related shaders", file.m_Name);
+                        Logging.LogDeferred<exl::log::Level::Info>("Saved %s and related shaders", file.m_Name);
                     } else {
-                        Logging.Log("Failed to compile %s and related shaders", file.m_Name);
+                        Logging.LogDeferred<exl::log::Level::Error>("Failed to compile %s and related shaders", file.m_Name);
                     }
                 } else {
                     char inputPath[nn::fs::MaxDirectoryEntryNameSize + 1];
@@ -272,25 +417,20 @@ HOOK_DEFINE_INLINE(AppMain) {
                     const s32 outputPathSize = nn::util::SNPrintf(outputPath, sizeof(outputPath), "sd:/output/%s.bin", file.m_Name);
                     outputPath[outputPathSize] = '\0';
 
-                    // check if file already exists
-                    char controlPath[nn::fs::MaxDirectoryEntryNameSize + 1];
-                    char codePath[nn::fs::MaxDirectoryEntryNameSize + 1];
-                    Concat(controlPath, sizeof(controlPath), outputPath, ".control");
-                    Concat(codePath, sizeof(codePath), outputPath, ".code");
+                    // check if the job was already published
+                    char markerPath[nn::fs::MaxDirectoryEntryNameSize + 1];
+                    Concat(markerPath, sizeof(markerPath), outputPath, cCompletionExtension);
                     nn::fs::FileHandle outputHandle{};
-                    if (nn::fs::OpenFile(&outputHandle, controlPath, nn::fs::OpenMode_Read) == 0) {
+                    if (nn::fs::OpenFile(&outputHandle, markerPath, nn::fs::OpenMode_Read) == 0) {
                         nn::fs::CloseFile(outputHandle);
-                        if (nn::fs::OpenFile(&outputHandle, codePath, nn::fs::OpenMode_Read) == 0) {
-                            nn::fs::CloseFile(outputHandle);
-                            continue;
-                        }
+                        continue;
                     }
 
-                    Logging.Log("Compiling %s", file.m_Name);
+                    Logging.LogDeferred<exl::log::Level::Info>("Compiling %s", file.m_Name);
                     if (CompileShader(inputPath, outputPath)) {
-                        Logging.Log("Saved %s to %s", inputPath, outputPath);
+                        Logging.LogDeferred<exl::log::Level::Info>("Saved %s to %s", inputPath, outputPath);
                     } else {
-                        Logging.Log("Failed to compile %s", inputPath);
+                        Logging.LogDeferred<exl::log::Level::Error>("Failed to compile %s", inputPath);
                     }
                 }
             }
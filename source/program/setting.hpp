@@ -1,6 +1,10 @@
 #pragma once
 
+#include <array>
+#include <string_view>
+
 #include "common.hpp"
+#include "lib/log/log_level.hpp"
 
 #define EXL_MODULE_NAME "exlaunch"
 
@@ -12,19 +16,71 @@
 */
 
 namespace exl::setting {
-    /* How large the fake .bss heap will be. */
-    constexpr size_t HeapSize = 0x5000;
-
     /* How large the JIT area will be for hooks. */
     constexpr size_t JitSize = 0x1000;
 
     /* How large the area will be inline hook pool. */
     constexpr size_t InlinePoolSize = 0x1000;
 
+    /* How much executable memory is mapped at once when the areas above run out. */
+    constexpr size_t JitGrowSize = 0x1000;
+
+    /* How many grows, across all hook pools, HeapSize leaves room for. Each one is a page aligned heap allocation. */
+    constexpr size_t JitGrowCount = 8;
+
+    /* How large the fake .bss heap will be, including room for the hook pools to grow. */
+    constexpr size_t HeapSize = 0x5000 + JitGrowCount * (JitGrowSize + PAGE_SIZE);
+
+    /* Whether HOOK_DEFINE_* hooks count their calls and the time spent in them, see lib/hook/stats.hpp. */
+    constexpr bool EnableHookStats = false;
+
+    /* How many names exl::reloc::GetSymbol remembers, including ones that weren't found. Must be a power of two. */
+    constexpr size_t SymbolCacheSize = 0x200;
+
+    /* How many dynamic symbols exl::reloc::Symbolize can index across all modules. Each one takes 8 bytes of .bss. */
+    constexpr size_t SymbolizerEntryCount = 0x4000;
+
+    /*
+        Whether calls to functions from the reloc tables are bound on the first call instead of when the tables are applied.
+        Enabling this takes over lazy resolution for the whole module, as GOT[1] and GOT[2] are overwritten to point at our resolver,
+        so every PLT slot of the module that is still unbound is resolved through the reloc tables instead of by rtld.
+    */
+    constexpr bool LazyBindRelocations = false;
+
+    /* Reloc table functions that are always bound up front, such as ones called from an exception handler or while patching. */
+    constexpr std::array<std::string_view, 0> EagerBindSymbols {};
+
     /* How large the formatting buffer should be for logging. The buffer will be on the stack. */
     constexpr size_t LogBufferSize = 512;
 
+    /* Leveled log calls below this level are compiled out entirely. */
+    constexpr log::Level LogLevel = log::Level::Info;
+
+    /* How many records the async logger can queue before dropping. Each record is slightly over LogBufferSize large. Must be a power of two. */
+    constexpr size_t AsyncLogQueueCount = 128;
+
+    /* Stack size and priority of the async logger drain thread. */
+    constexpr size_t AsyncLogThreadStackSize = 0x4000;
+    constexpr s32 AsyncLogThreadPriority = 31;
+
+    /* How often the async logger drains its queue, and how many intervals a flush will wait for. */
+    constexpr s64 AsyncLogDrainIntervalMs = 5;
+    constexpr s32 AsyncLogFlushWaitCount = 200;
+
+    /* Where the file logger writes to and how large its in-memory buffer is. */
+    constexpr const char FileLogPath[] = "sd:/output/log.txt";
+    constexpr size_t FileLogBufferSize = 0x10000;
+
+    /* How long the file logger may hold records before flushing, and at what size it rotates to a new file. */
+    constexpr s64 FileLogFlushIntervalMs = 2000;
+    constexpr s64 FileLogRotateSize = 0x400000;
+    /* How many rotated files to keep around (log.txt.1, log.txt.2, ...). */
+    constexpr s32 FileLogRotateCount = 2;
+
     /* Sanity checks. */
     static_assert(ALIGN_UP(JitSize, PAGE_SIZE) == JitSize, "");
     static_assert(ALIGN_UP(InlinePoolSize, PAGE_SIZE) == InlinePoolSize, "");
+    static_assert(ALIGN_UP(JitGrowSize, PAGE_SIZE) == JitGrowSize, "");
+    static_assert((AsyncLogQueueCount & (AsyncLogQueueCount - 1)) == 0, "");
+    static_assert((SymbolCacheSize & (SymbolCacheSize - 1)) == 0, "");
 }
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <array>
+#include <string_view>
 #include <common.hpp>
 
 namespace exl::util {
@@ -11,14 +13,21 @@ namespace exl::util {
         /* OTHER = 123 */
     };
 
-    namespace impl {
-        ALWAYS_INLINE UserVersion DetermineUserVersion() {
-            /* 
-                Implement a method of determining your application version here if you want to take advantage of this feature.
-                An example may be apply Murmur3 over the .text and .rodata of the main executable or calling nn::oe::GetDisplayVersion.
-                The former would have complications if other mods are in effect, and the latter may have issues with people doing safe downgrades on console.
-            */
-            return UserVersion::DEFAULT;
-        }
-    }
+    /*
+        Identifies the main executable of a version. Both values are logged when the executable isn't recognized.
+        The build ID is tried first, as it only takes finding a note in .rodata. The hash is XXH64 over .text and .rodata,
+        so it is only computed when no build ID matches, and it won't match if other mods patch the executable.
+    */
+    struct UserVersionInfo {
+        UserVersion m_Version;
+        /* Lowercase hex, a prefix of the full ID is enough. Empty to only match by hash. */
+        std::string_view m_BuildId;
+        /* Zero to only match by build ID. */
+        u64 m_Hash;
+    };
+
+    /* Bump the size when adding entries. Detection is skipped entirely while this is empty. */
+    constexpr std::array<UserVersionInfo, 0> UserVersionInfos {
+        /* UserVersionInfo { UserVersion::OTHER, "0123456789abcdef", 0x0123456789abcdef }, */
+    };
 }
\ No newline at end of file
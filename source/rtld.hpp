@@ -16,6 +16,16 @@ typedef Elf64_Xword Elf_Xword;
 #define ELF_ST_BIND ELF64_ST_BIND
 #define ELF_ST_VISIBILITY ELF64_ST_VISIBILITY
 
+#ifndef DT_GNU_HASH
+#define DT_GNU_HASH 0x6ffffef5
+#endif
+
+#ifndef DT_RELR
+#define DT_RELRSZ 35
+#define DT_RELR 36
+#define DT_RELRENT 37
+#endif
+
 #define ARCH_RELATIVE R_AARCH64_RELATIVE
 #define ARCH_JUMP_SLOT R_AARCH64_JUMP_SLOT
 #define ARCH_GLOB_DAT R_AARCH64_GLOB_DAT
@@ -35,6 +45,10 @@ namespace rtld {
     
     Elf_Addr lookup_global_auto(const char *name);
     typedef Elf_Addr (*lookup_global_t)(const char *);
+
+    // tried before the global lookup when a jump slot of g_LookupLazyModule is bound on its first call, other modules never consult it
+    extern lookup_global_t g_LookupLazyFunctionPointer;
+    extern ModuleObject *g_LookupLazyModule;
 }
 
 namespace nn::ro::detail {
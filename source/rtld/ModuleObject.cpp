@@ -149,6 +149,8 @@ void ModuleObject::Initialize(char *aslr_base, Elf_Dyn *dynamic) {
 #endif
                 break;
 
+            // no room for it here, see GnuHashTable
+            case DT_GNU_HASH:
             case DT_NEEDED:
             case DT_RPATH:
             case DT_SYMBOLIC:
@@ -209,6 +211,64 @@ Elf_Sym *ModuleObject::GetSymbolByName(const char *name) {
     return nullptr;
 }
 
+bool GnuHashTable::Initialize(char *aslr_base, Elf_Dyn *dynamic) {
+    *this = {};
+
+    for (; dynamic->d_tag != DT_NULL; dynamic++) {
+        if (dynamic->d_tag != DT_GNU_HASH) continue;
+
+        const uint32_t *hash_table =
+            (const uint32_t *)(aslr_base + dynamic->d_un.d_ptr);
+
+        this->nbucket = hash_table[0];
+        this->symoffset = hash_table[1];
+        this->bloom_size = hash_table[2];
+        this->bloom_shift = hash_table[3];
+        this->bloom = (const Elf_Addr *)&hash_table[4];
+        this->buckets = (const uint32_t *)&this->bloom[this->bloom_size];
+        this->chain = &this->buckets[this->nbucket];
+
+        // both are used as divisors during lookup
+        EXL_ASSERT(this->nbucket != 0 && this->bloom_size != 0);
+        return true;
+    }
+
+    return false;
+}
+
+Elf_Sym *GnuHashTable::GetSymbolByName(const ModuleObject *module,
+                                       const char *name, uint32_t hash) const {
+    constexpr uint32_t word_bits = sizeof(Elf_Addr) * 8;
+
+    // both bits have to be set for the symbol to possibly be in the table
+    const Elf_Addr word = this->bloom[(hash / word_bits) % this->bloom_size];
+    const Elf_Addr mask = ((Elf_Addr)1 << (hash % word_bits)) |
+                          ((Elf_Addr)1 << ((hash >> this->bloom_shift) % word_bits));
+    if ((word & mask) != mask) return nullptr;
+
+    uint32_t i = this->buckets[hash % this->nbucket];
+    if (i < this->symoffset) return nullptr;
+
+    // the low bit of a chain entry marks the end of the bucket
+    for (;; i++) {
+        const uint32_t chain_hash = this->chain[i - this->symoffset];
+        if ((hash | 1) == (chain_hash | 1)) {
+            const Elf_Sym *symbol = &module->dynsym[i];
+            bool is_common = symbol->st_shndx
+                                 ? symbol->st_shndx == SHN_COMMON
+                                 : true;
+            if (!is_common &&
+                strcmp(name, module->dynstr + symbol->st_name) == 0) {
+                return &module->dynsym[i];
+            }
+        }
+
+        if (chain_hash & 1) break;
+    }
+
+    return nullptr;
+}
+
 bool ModuleObject::TryResolveSymbol(Elf_Addr *target_symbol_address,
                                     Elf_Sym *symbol) {
     const char *name = &this->dynstr[symbol->st_name];
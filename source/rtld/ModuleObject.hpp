@@ -61,6 +61,25 @@ struct ModuleObject {
     bool TryResolveSymbol(Elf_Addr *target_symbol_address, Elf_Sym *symbol);
 };
 
+// ModuleObject mirrors the system rtld's layout and has no room for DT_GNU_HASH,
+// so the table is parsed separately from the same dynamic section.
+struct GnuHashTable {
+    uint32_t nbucket;
+    uint32_t symoffset;
+    uint32_t bloom_size;
+    uint32_t bloom_shift;
+    const Elf_Addr *bloom;
+    const uint32_t *buckets;
+    const uint32_t *chain;
+
+    // returns false if the module has no DT_GNU_HASH
+    bool Initialize(char *aslr_base, Elf_Dyn *dynamic);
+    bool IsValid() const { return this->buckets != nullptr; }
+    // hash must be the GNU hash of name
+    Elf_Sym *GetSymbolByName(const ModuleObject *module, const char *name,
+                             uint32_t hash) const;
+};
+
 #ifdef __RTLD_6XX__
 #ifdef __aarch64__
 static_assert(sizeof(ModuleObject) == 0xD0, "ModuleObject size isn't valid");
@@ -16,6 +16,24 @@ Elf_Addr rtld::lookup_global_auto(const char *name) {
     return 0;
 }
 
+rtld::lookup_global_t rtld::g_LookupLazyFunctionPointer = nullptr;
+rtld::ModuleObject *rtld::g_LookupLazyModule = nullptr;
+
+static bool try_resolve_lazy_symbol(rtld::ModuleObject *module,
+                                    Elf_Addr *target_symbol_address,
+                                    Elf_Sym *symbol) {
+    if (rtld::g_LookupLazyFunctionPointer && module == rtld::g_LookupLazyModule) {
+        Elf_Addr address =
+            rtld::g_LookupLazyFunctionPointer(&module->dynstr[symbol->st_name]);
+        if (address != 0) {
+            *target_symbol_address = address;
+            return true;
+        }
+    }
+
+    return module->TryResolveSymbol(target_symbol_address, symbol);
+}
+
 extern "C" Elf_Addr __rtld_lazy_bind_symbol(rtld::ModuleObject *module,
                                             size_t index) {
     if (module->is_rela) {
@@ -24,7 +42,7 @@ extern "C" Elf_Addr __rtld_lazy_bind_symbol(rtld::ModuleObject *module,
 
         Elf_Addr target_symbol_address;
 
-        if (module->TryResolveSymbol(&target_symbol_address, symbol)) {
+        if (try_resolve_lazy_symbol(module, &target_symbol_address, symbol)) {
             if (target_symbol_address == 0) {
                 return 0;
             }
@@ -39,7 +57,7 @@ extern "C" Elf_Addr __rtld_lazy_bind_symbol(rtld::ModuleObject *module,
 
         Elf_Addr target_symbol_address;
 
-        if (module->TryResolveSymbol(&target_symbol_address, symbol)) {
+        if (try_resolve_lazy_symbol(module, &target_symbol_address, symbol)) {
             return target_symbol_address;
         } else {
             print_unresolved_symbol(&module->dynstr[symbol->st_name]);
@@ -0,0 +1,81 @@
+#pragma once
+
+// only depends on elf.h so the loops can be tested on the host, see test/relocation_test.cpp.
+// these run before the module is relocated, so they must not touch any global state.
+
+#include <cstdint>
+#include <elf.h>
+
+#ifdef __ARM_NEON
+#include <arm_neon.h>
+#endif
+
+namespace rtld {
+
+// the leading DT_RELACOUNT/DT_RELCOUNT entries are all relative, so they skip the type check.
+inline void apply_relative_rela(uintptr_t aslr_base, const Elf64_Rela *entry, Elf64_Xword count) {
+    Elf64_Xword i = 0;
+
+#ifdef __ARM_NEON
+    const uint64x2_t base = vdupq_n_u64(aslr_base);
+    for (; i + 2 <= count; i += 2) {
+        // deinterleaves two entries into their offsets, infos and addends
+        const uint64x2x3_t pair = vld3q_u64((const uint64_t *)&entry[i]);
+        const uint64x2_t targets = vaddq_u64(pair.val[0], base);
+        const uint64x2_t values = vaddq_u64(pair.val[2], base);
+        *(Elf64_Addr *)vgetq_lane_u64(targets, 0) = vgetq_lane_u64(values, 0);
+        *(Elf64_Addr *)vgetq_lane_u64(targets, 1) = vgetq_lane_u64(values, 1);
+    }
+#endif
+
+    for (; i < count; i++) {
+        Elf64_Addr *ptr = (Elf64_Addr *)(aslr_base + entry[i].r_offset);
+        *ptr = (Elf64_Addr)aslr_base + entry[i].r_addend;
+    }
+}
+
+inline void apply_relative_rel(uintptr_t aslr_base, const Elf64_Rel *entry, Elf64_Xword count) {
+    Elf64_Xword i = 0;
+
+#ifdef __ARM_NEON
+    const uint64x2_t base = vdupq_n_u64(aslr_base);
+    for (; i + 2 <= count; i += 2) {
+        // deinterleaves two entries into their offsets and infos
+        const uint64x2x2_t pair = vld2q_u64((const uint64_t *)&entry[i]);
+        const uint64x2_t targets = vaddq_u64(pair.val[0], base);
+        Elf64_Addr *ptr0 = (Elf64_Addr *)vgetq_lane_u64(targets, 0);
+        Elf64_Addr *ptr1 = (Elf64_Addr *)vgetq_lane_u64(targets, 1);
+        const uint64x2_t values = vaddq_u64(vcombine_u64(vcreate_u64(*ptr0), vcreate_u64(*ptr1)), base);
+        *ptr0 = vgetq_lane_u64(values, 0);
+        *ptr1 = vgetq_lane_u64(values, 1);
+    }
+#endif
+
+    for (; i < count; i++) {
+        Elf64_Addr *ptr = (Elf64_Addr *)(aslr_base + entry[i].r_offset);
+        *ptr += (Elf64_Addr)aslr_base;
+    }
+}
+
+// packed relative relocations: an even entry is the address of the next slot to relocate,
+// an odd one is a bitmap of which of the 63 slots after the current position need it too
+inline void apply_relr(uintptr_t aslr_base, const Elf64_Addr *entry, Elf64_Xword size) {
+    const Elf64_Addr *end = (const Elf64_Addr *)((uintptr_t)entry + size);
+    Elf64_Addr *where = nullptr;
+
+    for (; entry < end; entry++) {
+        Elf64_Addr value = *entry;
+        if ((value & 1) == 0) {
+            where = (Elf64_Addr *)(aslr_base + value);
+            *where++ += (Elf64_Addr)aslr_base;
+            continue;
+        }
+
+        for (Elf64_Addr *ptr = where; (value >>= 1) != 0; ptr++) {
+            if (value & 1) *ptr += (Elf64_Addr)aslr_base;
+        }
+        where += sizeof(Elf64_Addr) * 8 - 1;
+    }
+}
+
+}
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include <common.hpp>
 
 #include "../rtld.hpp"
+#include "relative_relocs.hpp"
 
 extern "C" {
     __attribute__((section(".bss")))
@@ -10,6 +11,7 @@ extern "C" {
     {
         Elf_Addr rela = 0;
         Elf_Addr rel = 0;
+        Elf_Addr relr = 0;
 
         Elf_Xword rela_entry_size = sizeof(Elf_Rela);
         Elf_Xword rel_entry_size = sizeof(Elf_Rel);
@@ -19,6 +21,7 @@ extern "C" {
 
         Elf_Xword rela_size = 0;
         Elf_Xword rel_size = 0;
+        Elf_Xword relr_size = 0;
 
         for (; dynamic->d_tag != DT_NULL; dynamic++) {
             switch (dynamic->d_tag) {
@@ -54,6 +57,18 @@ extern "C" {
                     rel_entry_count = dynamic->d_un.d_val;
                     continue;
 
+                case DT_RELR:
+                    relr = ((Elf_Addr)aslr_base + dynamic->d_un.d_ptr);
+                    continue;
+
+                case DT_RELRSZ:
+                    relr_size = dynamic->d_un.d_val;
+                    continue;
+
+                // entries are always sizeof(Elf_Addr)
+                case DT_RELRENT:
+                    continue;
+
                 // those are nop on the real rtld
                 case DT_NEEDED:
                 case DT_PLTRELSZ:
@@ -73,11 +88,24 @@ extern "C" {
             }
         }
         
+        // the counts only cover relative entries, which can take the fast path as long as the entries are packed
+        bool rela_all_relative = rela_entry_count != 0 && rela_entry_size == sizeof(Elf_Rela);
+        bool rel_all_relative = rel_entry_count != 0 && rel_entry_size == sizeof(Elf_Rel);
+
         if(rela_entry_count == 0)
             rela_entry_count = rela_size / rela_entry_size;
         if(rel_entry_count == 0)
             rel_entry_count = rel_size / rel_entry_size;
 
+        if (rel_all_relative) {
+            rtld::apply_relative_rel(aslr_base, (const Elf_Rel *)rel, rel_entry_count);
+            rel_entry_count = 0;
+        }
+
+        if (rela_all_relative) {
+            rtld::apply_relative_rela(aslr_base, (const Elf_Rela *)rela, rela_entry_count);
+            rela_entry_count = 0;
+        }
 
         if (rel_entry_count) {
             Elf_Xword i = 0;
@@ -111,5 +139,9 @@ extern "C" {
                 i++;
             }
         }
+
+        if (relr_size) {
+            rtld::apply_relr(aslr_base, (const Elf_Addr *)relr, relr_size);
+        }
     }
 };
\ No newline at end of file
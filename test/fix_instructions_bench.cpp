@@ -0,0 +1,51 @@
+#include <lib/hook/nx64/fix_instructions.hpp>
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace nx64 = exl::hook::nx64;
+
+/* Relocation throughput over hook sized blocks with a realistic share of PC-relative instructions. */
+int main(int argc, char** argv) {
+    const int iterations = argc > 1 ? std::atoi(argv[1]) : 2000000;
+
+    std::mt19937 random(0xbe7c);
+    /* Prologue style instructions, a BL, an ADRP and a B.cond, and a far literal load mixed in. */
+    constexpr uint32_t Pool[] = {
+        0xa9bf7bfdu, 0x910003fdu, 0xf9000bf3u, 0xaa0003f3u, 0x8b020020u,
+        0x94000100u, 0x90000022u, 0x54000081u, 0x58000041u,
+    };
+
+    constexpr size_t Blocks = 0x400;
+    std::vector<std::array<uint32_t, nx64::MaxInstructions + 2>> in(Blocks);
+    for(auto& block : in) {
+        for(auto& ins : block)
+            ins = Pool[random() % std::size(Pool)];
+    }
+    /* The code is read through its rw view, the rx one is only read for literals. */
+    const auto inRx = in;
+
+    std::array<uint32_t, nx64::GetFixedInstructionsSize(nx64::MaxInstructions)> out;
+    /* Alternate near and far destinations, a hook's trampoline can land either way. */
+    const uint64_t near = reinterpret_cast<uint64_t>(inRx.data()) + 0x100000;
+    const uint64_t far = reinterpret_cast<uint64_t>(inRx.data()) + 0x100000000;
+
+    uint64_t sink = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for(int i = 0; i < iterations; i++) {
+        auto& block = in[i % Blocks];
+        auto blockRx = const_cast<uint32_t*>(inRx[i % Blocks].data());
+        auto outRx = reinterpret_cast<uint32_t*>((i & 1) ? far : near);
+        nx64::__fix_instructions(block.data(), blockRx, nx64::MaxInstructions, out.data(), outRx);
+        sink += out[0];
+    }
+    const auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    std::printf("fix_instructions: %d blocks of %d, %.1f ns/block, %.2f ns/instruction (%llx)\n", iterations, int(nx64::MaxInstructions),
+                elapsed / iterations, elapsed / (double(iterations) * nx64::MaxInstructions), static_cast<unsigned long long>(sink & 0xf));
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,474 @@
+#include <lib/hook/nx64/fix_instructions.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "test.hpp"
+
+namespace nx64 = exl::hook::nx64;
+
+namespace {
+
+    /*
+        Just enough of an A64 interpreter to run relocated code: branches, literal loads, ADR/ADRP and BR/BLR.
+        Anything else is treated as an instruction without side effects, which is all the relocators pass through.
+    */
+    struct Memory {
+        /* Where relocated code was written, and the address it was relocated for. */
+        const uint32_t* m_Out;
+        uint64_t m_OutRx;
+        size_t m_OutSize;
+
+        bool Read(uint64_t address, void* dst, size_t size) const {
+            if(address >= m_OutRx && address + size <= m_OutRx + m_OutSize) {
+                std::memcpy(dst, reinterpret_cast<const uint8_t*>(m_Out) + (address - m_OutRx), size);
+                return true;
+            }
+            /* Input code and its literals are read in place. */
+            std::memcpy(dst, reinterpret_cast<const void*>(address), size);
+            return true;
+        }
+    };
+
+    struct Cpu {
+        uint64_t m_X[32];
+        uint8_t m_V[32][16];
+        uint32_t m_Nzcv;
+        uint64_t m_Pc;
+        /* Whether LR holds a return address from a BL, which won't match between original and relocated code. */
+        bool m_LrFromCall;
+    };
+
+    enum class Exit {
+        Left,
+        Looped,
+        Undefined,
+    };
+
+    constexpr uint32_t Sentinel = 0x00dead00u;
+
+    int64_t SignExtend(uint64_t value, int bits) {
+        return int64_t(value << (64 - bits)) >> (64 - bits);
+    }
+
+    bool CheckCondition(uint32_t cond, uint32_t nzcv) {
+        const bool n = nzcv & 8, z = nzcv & 4, c = nzcv & 2, v = nzcv & 1;
+        bool result;
+        switch(cond >> 1) {
+            case 0: result = z; break;
+            case 1: result = c; break;
+            case 2: result = n; break;
+            case 3: result = v; break;
+            case 4: result = c && !z; break;
+            case 5: result = n == v; break;
+            case 6: result = n == v && !z; break;
+            default: result = true; break;
+        }
+        if((cond & 1) && cond != 0xf)
+            result = !result;
+        return result;
+    }
+
+    void WriteX(Cpu& cpu, uint32_t rd, uint64_t value) {
+        if(rd == 31)
+            return;
+        cpu.m_X[rd] = value;
+        if(rd == 30)
+            cpu.m_LrFromCall = false;
+    }
+
+    bool Step(Cpu& cpu, const Memory& mem) {
+        uint32_t ins;
+        mem.Read(cpu.m_Pc, &ins, sizeof(ins));
+        if(ins == Sentinel)
+            return false;
+
+        const uint64_t pc = cpu.m_Pc;
+        uint64_t next = pc + 4;
+        const uint32_t rt = ins & 0x1f;
+
+        if((ins & 0x7c000000u) == 0x14000000u) {
+            /* B, BL */
+            if(ins & 0x80000000u) {
+                WriteX(cpu, 30, pc + 4);
+                cpu.m_LrFromCall = true;
+            }
+            next = pc + SignExtend(ins & 0x03ffffffu, 26) * 4;
+        } else if((ins & 0xff000010u) == 0x54000000u) {
+            /* B.cond */
+            if(CheckCondition(ins & 0xf, cpu.m_Nzcv))
+                next = pc + SignExtend((ins >> 5) & 0x7ffff, 19) * 4;
+        } else if((ins & 0x7e000000u) == 0x34000000u) {
+            /* CBZ, CBNZ */
+            uint64_t value = cpu.m_X[rt];
+            if(!(ins & 0x80000000u))
+                value &= 0xffffffffu;
+            if((value == 0) != bool(ins & 0x01000000u))
+                next = pc + SignExtend((ins >> 5) & 0x7ffff, 19) * 4;
+        } else if((ins & 0x7e000000u) == 0x36000000u) {
+            /* TBZ, TBNZ */
+            const uint32_t bit = ((ins >> 26) & 0x20) | ((ins >> 19) & 0x1f);
+            if(((cpu.m_X[rt] >> bit) & 1) == ((ins >> 24) & 1))
+                next = pc + SignExtend((ins >> 5) & 0x3fff, 14) * 4;
+        } else if((ins & 0x3b000000u) == 0x18000000u) {
+            /* LDR (literal), LDRSW (literal), PRFM (literal) */
+            const uint32_t opc = ins >> 30;
+            const bool simd = ins & 0x04000000u;
+            const uint64_t address = pc + SignExtend((ins >> 5) & 0x7ffff, 19) * 4;
+            if(simd) {
+                if(opc == 3)
+                    return false;
+                std::memset(cpu.m_V[rt], 0, sizeof(cpu.m_V[rt]));
+                mem.Read(address, cpu.m_V[rt], size_t(4) << opc);
+            } else if(opc == 0) {
+                uint32_t value;
+                mem.Read(address, &value, sizeof(value));
+                WriteX(cpu, rt, value);
+            } else if(opc == 1) {
+                uint64_t value;
+                mem.Read(address, &value, sizeof(value));
+                WriteX(cpu, rt, value);
+            } else if(opc == 2) {
+                int32_t value;
+                mem.Read(address, &value, sizeof(value));
+                WriteX(cpu, rt, uint64_t(int64_t(value)));
+            }
+        } else if((ins & 0x1f000000u) == 0x10000000u) {
+            /* ADR, ADRP */
+            const int64_t imm = SignExtend((((ins >> 5) & 0x7ffff) << 2) | ((ins >> 29) & 3), 21);
+            if(ins & 0x80000000u)
+                WriteX(cpu, rt, (pc & ~uint64_t(0xfff)) + (imm << 12));
+            else
+                WriteX(cpu, rt, pc + imm);
+        } else if((ins & 0xffdffc1fu) == 0xd61f0000u) {
+            /* BR, BLR */
+            next = cpu.m_X[(ins >> 5) & 0x1f];
+            if(ins & 0x00200000u) {
+                WriteX(cpu, 30, pc + 4);
+                cpu.m_LrFromCall = true;
+            }
+        }
+
+        cpu.m_Pc = next;
+        return true;
+    }
+
+    /* Runs until the PC leaves [begin, end). */
+    Exit Run(Cpu& cpu, const Memory& mem, uint64_t begin, uint64_t end) {
+        for(int steps = 0; steps < 0x100; steps++) {
+            if(cpu.m_Pc < begin || cpu.m_Pc >= end)
+                return Exit::Left;
+            if(!Step(cpu, mem))
+                return Exit::Undefined;
+        }
+        return Exit::Looped;
+    }
+
+    constexpr size_t OutWords = nx64::GetFixedInstructionsSize(nx64::MaxInstructions);
+    using OutBuffer = std::array<uint32_t, OutWords + 8>;
+
+    /* Relocates into a sentinel filled buffer, returning how many words were written. */
+    size_t Relocate(uint32_t* in, int32_t count, uint64_t outRx, OutBuffer& out) {
+        /* Like a hook, instructions are read through a separate view of the code. */
+        std::array<uint32_t, nx64::MaxInstructions> inRw;
+        std::copy_n(in, count, inRw.begin());
+
+        /* Run twice with different fill patterns so literals that happen to match the sentinel still count as written. */
+        OutBuffer other;
+        out.fill(Sentinel);
+        other.fill(~Sentinel);
+        EXL_CHECK(nx64::__fix_instructions(inRw.data(), in, count, out.data(), reinterpret_cast<uint32_t*>(outRx)));
+        EXL_CHECK(nx64::__fix_instructions(inRw.data(), in, count, other.data(), reinterpret_cast<uint32_t*>(outRx)));
+
+        size_t written = 0;
+        for(size_t i = 0; i < out.size(); i++) {
+            if(out[i] != Sentinel || other[i] != ~Sentinel)
+                written = i + 1;
+        }
+        return written;
+    }
+
+    /*
+        Encoding table, expected outputs are worked out by hand from the architecture manual.
+        Input executes at 0x10000000; near outputs are placed at 0x10001000 and far ones at 0x90000000.
+    */
+    struct TableCase {
+        const char* m_Name;
+        uint64_t m_OutRx;
+        std::vector<uint32_t> m_In;
+        std::vector<uint32_t> m_Out;
+    };
+
+    constexpr uint64_t TableInRx = 0x10000000;
+    constexpr uint64_t TableNear = 0x10001000;
+    constexpr uint64_t TableFar = 0x90000000;
+
+    /* LDR X17, #0x8; BR X17; .quad 0x10000000 + offset */
+    #define FAR_BRANCH(offset) 0x58000051u, 0xd61f0220u, uint32_t(TableInRx + (offset)), 0u
+
+    const std::vector<TableCase> TableCases = {
+        /* Copied as is, then B back from 0x10001004 to 0x10000004. */
+        { "add",                TableNear,      { 0x8b020020u },                { 0x8b020020u, 0x17fffc00u } },
+        { "b near",             TableNear,      { 0x14000010u },                { 0x17fffc10u, 0x17fffc00u } },
+        { "bl near",            TableNear,      { 0x94000010u },                { 0x97fffc10u, 0x17fffc00u } },
+        { "b far",              TableFar,       { 0x14000010u },                { FAR_BRANCH(0x40), FAR_BRANCH(0x4) } },
+        /* Padded so the literal after LDR X17, #12; ADR X30, #16; BR X17 is aligned, ADR then lands on the branch back. */
+        { "bl far",             TableFar,       { 0x94000010u },                { nx64::Aarch64Nop, 0x58000071u, 0x1000009eu, 0xd61f0220u, 0x10000040u, 0u, FAR_BRANCH(0x4) } },
+        { "b.eq near",          TableNear,      { 0x54000080u },                { 0x54ff8080u, 0x17fffc00u } },
+        /* B.NE #0x8; B #0x14; then an absolute branch to the target. */
+        { "b.ne far",           TableFar,       { 0x54000081u },                { 0x54000041u, 0x14000005u, FAR_BRANCH(0x10), FAR_BRANCH(0x4) } },
+        { "cbz x3 near",        TableNear,      { 0xb4000103u },                { 0xb4ff8103u, 0x17fffc00u } },
+        { "tbnz w5 far",        TableFar + 4,   { 0x37180105u },                { nx64::Aarch64Nop, 0x37180045u, 0x14000005u, FAR_BRANCH(0x20), FAR_BRANCH(0x4) } },
+        { "ldr x1 near",        TableNear,      { 0x58000801u },                { 0x58ff8801u, 0x17fffc00u } },
+        { "ldr w1 near",        TableNear,      { 0x18000801u },                { 0x18ff8801u, 0x17fffc00u } },
+        { "ldr s2 near",        TableNear,      { 0x1c000802u },                { 0x1cff8802u, 0x17fffc00u } },
+        { "prfm",               TableNear,      { 0xd8000800u },                { 0x17fffc01u } },
+        { "adr x0 near",        TableNear,      { 0x30000800u },                { 0x30ff8800u, 0x17fffc00u } },
+        /* LDR X0, #0x8; B #0xc; .quad target */
+        { "adr x0 far",         TableFar,       { 0x30000800u },                { 0x58000040u, 0x14000003u, 0x10000101u, 0u, FAR_BRANCH(0x4) } },
+        { "adrp x2",            TableNear,      { 0x90000022u },                { 0x58000042u, 0x14000003u, 0x10004000u, 0u, 0x17fffbfdu } },
+        /* The block's own page is still the original page, not the trampoline's. */
+        { "adrp x2 own page",   TableNear,      { 0x90000002u },                { 0x58000042u, 0x14000003u, 0x10000000u, 0u, 0x17fffbfdu } },
+        /* B #0x8 skips an instruction within the block, so it targets the relocated copy. */
+        { "b within",           TableNear,      { 0x14000002u, 0x8b020020u, 0x8b020020u }, { 0x14000002u, 0x8b020020u, 0x8b020020u, 0x17fffc00u } },
+        { "cbz within far",     TableFar,       { 0xb4000043u, 0x94000010u, 0x8b020020u },
+                                                { 0xb40000c3u, 0x58000071u, 0x1000009eu, 0xd61f0220u, 0x10000044u, 0u, 0x8b020020u, nx64::Aarch64Nop, FAR_BRANCH(0xc) } },
+    };
+
+    #undef FAR_BRANCH
+
+    void TestTable() {
+        for(const auto& tc : TableCases) {
+            /* The input addresses are only ever used for arithmetic, except for literals which the table avoids. */
+            std::vector<uint32_t> in = tc.m_In;
+            OutBuffer out;
+            OutBuffer other;
+            out.fill(Sentinel);
+            other.fill(~Sentinel);
+            auto inRx = reinterpret_cast<uint32_t*>(TableInRx);
+            EXL_CHECK(nx64::__fix_instructions(in.data(), inRx, int32_t(in.size()), out.data(), reinterpret_cast<uint32_t*>(tc.m_OutRx)));
+            EXL_CHECK(nx64::__fix_instructions(in.data(), inRx, int32_t(in.size()), other.data(), reinterpret_cast<uint32_t*>(tc.m_OutRx)));
+
+            size_t written = 0;
+            for(size_t i = 0; i < out.size(); i++) {
+                if(out[i] != Sentinel || other[i] != ~Sentinel)
+                    written = i + 1;
+            }
+            if(written != tc.m_Out.size())
+                std::fprintf(stderr, "%s: wrote %zu words, expected %zu\n", tc.m_Name, written, tc.m_Out.size());
+            EXL_CHECK_EQ(written, tc.m_Out.size());
+            for(size_t i = 0; i < std::min(written, tc.m_Out.size()); i++) {
+                if(out[i] != tc.m_Out[i])
+                    std::fprintf(stderr, "%s: word %zu\n", tc.m_Name, i);
+                EXL_CHECK_EQ(out[i], tc.m_Out[i]);
+            }
+        }
+
+        /* Too many instructions is refused without writing anything. */
+        std::array<uint32_t, nx64::MaxInstructions + 1> in;
+        in.fill(0x8b020020u);
+        OutBuffer out;
+        out.fill(Sentinel);
+        EXL_CHECK(!nx64::__fix_instructions(in.data(), reinterpret_cast<uint32_t*>(TableInRx), int32_t(in.size()),
+                                            out.data(), reinterpret_cast<uint32_t*>(TableNear)));
+        EXL_CHECK_EQ(out[0], Sentinel);
+    }
+
+    /*
+        Fuzzing: random PC-relative instructions are relocated to random distances, then both the original and the
+        relocated code are interpreted from the same state. They have to leave at the same address with the same
+        registers, apart from X17 which far branches clobber on their way out.
+    */
+    struct Fuzzer {
+        /* Input code sits in the middle, so every literal it can reach is readable. */
+        static constexpr size_t ArenaWords = 0x100000;
+        static constexpr size_t BlockWords = 0x4000;
+
+        std::mt19937_64 m_Random;
+        std::vector<uint32_t> m_Arena;
+        uint64_t m_ArenaBegin;
+        uint64_t m_ArenaEnd;
+
+        explicit Fuzzer(uint64_t seed) : m_Random(seed), m_Arena(ArenaWords) {
+            for(auto& word : m_Arena)
+                word = uint32_t(m_Random());
+            m_ArenaBegin = reinterpret_cast<uint64_t>(m_Arena.data());
+            m_ArenaEnd = m_ArenaBegin + ArenaWords * sizeof(uint32_t);
+        }
+
+        uint64_t Bits(int count) {
+            return m_Random() & ((uint64_t(1) << count) - 1);
+        }
+
+        /* Mostly short offsets, which are the interesting ones around the reach of each form. */
+        uint32_t Offset(int bits) {
+            uint64_t offset;
+            switch(m_Random() % 4) {
+                case 0: offset = Bits(6) - 0x20; break;
+                case 1: offset = Bits(std::min(bits, 14)); break;
+                default: offset = Bits(bits); break;
+            }
+            return uint32_t(offset & ((uint64_t(1) << bits) - 1));
+        }
+
+        uint32_t Register() {
+            /* X17 is the relocators' scratch register, and LR differs after a call within the block. */
+            uint32_t r = m_Random() % 30;
+            return r == 17 ? 16 : r;
+        }
+
+        uint32_t Generate(bool allowAddress) {
+            switch(m_Random() % (allowAddress ? 10 : 8)) {
+                case 0: return 0x14000000u | Offset(26);
+                case 1: return 0x94000000u | Offset(26);
+                case 2: return 0x54000000u | (Offset(19) << 5) | uint32_t(Bits(4));
+                case 3: return 0x34000000u | uint32_t(Bits(1) << 31) | uint32_t(Bits(1) << 24) | (Offset(19) << 5) | Register();
+                case 4: return 0x36000000u | uint32_t(Bits(1) << 31) | uint32_t(Bits(6 - 1) << 19) | uint32_t(Bits(1) << 24) | (Offset(14) << 5) | Register();
+                case 5: {
+                    /* W, X, LDRSW, PRFM, S, D and Q loads. */
+                    static constexpr uint32_t Ops[] = { 0x18000000u, 0x58000000u, 0x98000000u, 0xd8000000u, 0x1c000000u, 0x5c000000u, 0x9c000000u };
+                    /* Keep the literal inside the arena. */
+                    const uint32_t offset = uint32_t(Bits(16) - 0x8000) & 0x7ffff;
+                    return Ops[m_Random() % std::size(Ops)] | (offset << 5) | Register();
+                }
+                case 6:
+                case 7: return 0x8b020020u;
+                case 8: return 0x10000000u | uint32_t(Bits(2) << 29) | (Offset(19) << 5) | Register();
+                default: return 0x90000000u | uint32_t(Bits(2) << 29) | (Offset(19) << 5) | Register();
+            }
+        }
+
+        uint64_t PickOut(uint64_t inRx) {
+            for(;;) {
+                uint64_t outRx;
+                switch(m_Random() % 4) {
+                    case 0: outRx = inRx + Bits(22) - (uint64_t(1) << 21); break;
+                    case 1: outRx = inRx + Bits(28) - (uint64_t(1) << 27); break;
+                    case 2: outRx = inRx + Bits(36); break;
+                    default: outRx = Bits(47); break;
+                }
+                outRx &= ~uint64_t(3);
+                /* Must not overlap the input, which is read in place. */
+                if(outRx + sizeof(OutBuffer) <= m_ArenaBegin || outRx >= m_ArenaEnd)
+                    return outRx;
+            }
+        }
+
+        void RandomizeCpu(Cpu& cpu) {
+            for(auto& x : cpu.m_X) {
+                /* Zero often enough for CBZ to go both ways. */
+                x = m_Random() % 3 == 0 ? 0 : m_Random();
+            }
+            std::memset(cpu.m_V, 0, sizeof(cpu.m_V));
+            cpu.m_Nzcv = uint32_t(Bits(4));
+            cpu.m_LrFromCall = false;
+        }
+
+        bool Iterate() {
+            const int32_t count = int32_t(1 + m_Random() % nx64::MaxInstructions);
+            /* Page aligned blocks now and then, for ADRP of the block's own page. */
+            size_t index = ArenaWords / 2 - BlockWords / 2 + (m_Random() % 8 == 0 ? 0 : Bits(14));
+            uint32_t* in = &m_Arena[index];
+            const uint64_t inRx = reinterpret_cast<uint64_t>(in);
+
+            /* ADR and ADRP into the block itself would point at the original instructions rather than the copies. */
+            for(int32_t i = 0; i < count; i++) {
+                do {
+                    in[i] = Generate(true);
+                } while(!Acceptable(in[i], inRx + i * 4, inRx, inRx + count * 4));
+            }
+
+            OutBuffer out;
+            const uint64_t outRx = PickOut(inRx);
+            const size_t written = Relocate(in, count, outRx, out);
+            EXL_CHECK(written <= nx64::GetFixedInstructionsSize(count));
+
+            const Memory mem = { out.data(), outRx, out.size() * sizeof(uint32_t) };
+            bool ok = true;
+            for(int run = 0; run < 4; run++) {
+                Cpu original;
+                RandomizeCpu(original);
+                original.m_Pc = inRx;
+                Cpu relocated = original;
+                relocated.m_Pc = outRx;
+
+                /* Returning from a call resumes both where they left off, until the whole block has been left for good. */
+                for(int32_t leg = 0; leg <= count; leg++) {
+                    const Exit originalExit = Run(original, mem, inRx, inRx + count * 4);
+                    const Exit relocatedExit = Run(relocated, mem, outRx, outRx + written * 4);
+                    ok &= originalExit == Exit::Left && relocatedExit == Exit::Left;
+                    ok &= original.m_Pc == relocated.m_Pc;
+                    for(int r = 0; r < 31; r++) {
+                        if(r == 17 || (r == 30 && original.m_LrFromCall))
+                            continue;
+                        ok &= original.m_X[r] == relocated.m_X[r];
+                    }
+                    ok &= std::memcmp(original.m_V, relocated.m_V, sizeof(original.m_V)) == 0;
+
+                    if(!ok || !original.m_LrFromCall)
+                        break;
+                    original.m_Pc = original.m_X[30];
+                    relocated.m_Pc = relocated.m_X[30];
+                    /* Only the original's return address is visible to the callee's caller afterwards. */
+                    relocated.m_X[30] = original.m_X[30];
+                    original.m_LrFromCall = false;
+                }
+            }
+
+            if(!ok) {
+                std::fprintf(stderr, "mismatch relocating from 0x%" PRIx64 " to 0x%" PRIx64 ":", inRx, outRx);
+                for(int32_t i = 0; i < count; i++)
+                    std::fprintf(stderr, " %08x", in[i]);
+                std::fprintf(stderr, "\n");
+                exl::test::s_Failures++;
+            }
+            return ok;
+        }
+
+        static bool Acceptable(uint32_t ins, uint64_t pc, uint64_t begin, uint64_t end) {
+            if((ins & 0x1f000000u) != 0x10000000u) {
+                /* Branches into the block may only go forwards, so nothing loops. */
+                int64_t offset;
+                if((ins & 0x7c000000u) == 0x14000000u)
+                    offset = SignExtend(ins & 0x03ffffffu, 26) * 4;
+                else if((ins & 0xff000010u) == 0x54000000u || (ins & 0x7e000000u) == 0x34000000u)
+                    offset = SignExtend((ins >> 5) & 0x7ffff, 19) * 4;
+                else if((ins & 0x7e000000u) == 0x36000000u)
+                    offset = SignExtend((ins >> 5) & 0x3fff, 14) * 4;
+                else
+                    return true;
+                const uint64_t target = pc + offset;
+                return target < begin || target >= end || target > pc;
+            }
+
+            const int64_t imm = SignExtend((((ins >> 5) & 0x7ffff) << 2) | ((ins >> 29) & 3), 21);
+            if(ins & 0x80000000u)
+                return true;
+            const uint64_t target = pc + imm;
+            return target < begin || target >= end;
+        }
+    };
+
+    void TestFuzz(uint64_t seed, int iterations) {
+        Fuzzer fuzzer(seed);
+        int reported = 0;
+        for(int i = 0; i < iterations; i++) {
+            /* Don't drown the output if a relocator is broken outright. */
+            if(!fuzzer.Iterate() && ++reported == 20)
+                break;
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    const int iterations = argc > 1 ? std::atoi(argv[1]) : 200000;
+    const uint64_t seed = argc > 2 ? std::strtoull(argv[2], nullptr, 0) : 0x5eed;
+
+    TestTable();
+    TestFuzz(seed, iterations);
+    return exl::test::Finish("fix_instructions");
+}
\ No newline at end of file
@@ -0,0 +1,216 @@
+#include <program/glslc_view.hpp>
+
+#include <initializer_list>
+#include <vector>
+
+#include "test.hpp"
+
+namespace {
+
+    struct GpuSection {
+        NVNshaderStage m_Stage;
+        u32 m_CodeSize;
+        u32 m_ShaderOffset;
+        u32 m_ShaderSize;
+        u32 m_ConstbufOffset = 0;
+        u32 m_ConstbufSize = 0;
+        u32 m_ControlSize = ControlSectionView::MinimumSize;
+    };
+
+    /* A glslc output blob with a GPU code section per entry, code bytes are numbered so slices can be told apart. */
+    class TestOutput {
+    public:
+        TestOutput(std::initializer_list<GpuSection> sections) {
+            size_t size = offsetof(GLSLCoutput, headers) + sections.size() * sizeof(GLSLCsectionHeaderUnion);
+            for(const auto& section : sections)
+                size += section.m_ControlSize + section.m_CodeSize;
+
+            /* The view overlays the blob with GLSLCoutput, so it has to be aligned like glslc's own output. */
+            m_Storage.resize((size + sizeof(u64) - 1) / sizeof(u64));
+            m_Size = size;
+
+            auto output = GetOutput();
+            output->size = u32(size);
+            output->numSections = u32(sections.size());
+
+            size_t offset = offsetof(GLSLCoutput, headers) + sections.size() * sizeof(GLSLCsectionHeaderUnion);
+            u32 index = 0;
+            for(const auto& section : sections) {
+                auto& header = output->headers[index++].gpuCodeHeader;
+                header.common.type = GLSLC_SECTION_TYPE_GPU_CODE;
+                header.common.dataOffset = u32(offset);
+                header.common.size = section.m_ControlSize + section.m_CodeSize;
+                header.stage = section.m_Stage;
+                header.controlOffset = 0;
+                header.controlSize = section.m_ControlSize;
+                header.dataOffset = section.m_ControlSize;
+                header.dataSize = section.m_CodeSize;
+
+                u8* control = GetBytes() + offset;
+                if(section.m_ControlSize >= ControlSectionView::MinimumSize) {
+                    Write(control, ControlSectionView::ShaderOffsetOffset, section.m_ShaderOffset);
+                    Write(control, ControlSectionView::ShaderSizeOffset, section.m_ShaderSize);
+                    Write(control, ControlSectionView::ConstbufOffsetOffset, section.m_ConstbufOffset);
+                    Write(control, ControlSectionView::ConstbufSizeOffset, section.m_ConstbufSize);
+                    Write(control, ControlSectionView::StageOffset, u32(section.m_Stage));
+                }
+
+                u8* code = control + section.m_ControlSize;
+                for(u32 i = 0; i < section.m_CodeSize; i++)
+                    code[i] = u8(i);
+                offset += section.m_ControlSize + section.m_CodeSize;
+            }
+        }
+
+        GLSLCoutput* GetOutput() {
+            return reinterpret_cast<GLSLCoutput*>(m_Storage.data());
+        }
+
+        u8* GetBytes() {
+            return reinterpret_cast<u8*>(m_Storage.data());
+        }
+
+        GlslcOutputView GetView() {
+            return GlslcOutputView(GetOutput());
+        }
+
+        size_t GetSize() const {
+            return m_Size;
+        }
+
+    private:
+        static void Write(u8* control, size_t offset, u32 value) {
+            std::memcpy(control + offset, &value, sizeof(value));
+        }
+
+        std::vector<u64> m_Storage;
+        size_t m_Size;
+    };
+
+    void TestByteView() {
+        const u8 bytes[] = { 0, 1, 2, 3, 4, 5, 6, 7 };
+        const ByteView view(bytes, sizeof(bytes));
+
+        EXL_CHECK(view.Contains(0, 8));
+        EXL_CHECK(view.Contains(8, 0));
+        EXL_CHECK(!view.Contains(4, 5));
+        EXL_CHECK(!view.Contains(9, 0));
+        /* Offset and size that wrap around when added. */
+        EXL_CHECK(!view.Contains(4, SIZE_MAX));
+
+        EXL_CHECK_EQ(view.Slice(2, 4).GetSize(), 4u);
+        EXL_CHECK_EQ(view.Slice(2, 4).GetData()[0], 2);
+        EXL_CHECK(view.Slice(6, 4).IsEmpty());
+        EXL_CHECK_EQ(view.Slice(6).GetSize(), 2u);
+        EXL_CHECK(view.Slice(8).IsEmpty());
+        EXL_CHECK(view.Slice(9).IsEmpty());
+
+        u32 word = 0;
+        EXL_CHECK(view.Read(&word, 1));
+        EXL_CHECK_EQ(word, 0x04030201u);
+        EXL_CHECK(!view.Read(&word, 5));
+        EXL_CHECK_EQ(word, 0x04030201u);
+
+        EXL_CHECK(ByteView(nullptr, 0x10).IsEmpty());
+    }
+
+    void TestOutputView() {
+        TestOutput output({
+            { NVN_SHADER_STAGE_VERTEX, 0x200, 0x30, 0x150, 0x1c0, 0x40 },
+            { NVN_SHADER_STAGE_FRAGMENT, 0x100, 0x0, 0x100 },
+        });
+        const GlslcOutputView view = output.GetView();
+        EXL_CHECK(view.IsValid());
+        EXL_CHECK_EQ(view.GetSectionCount(), 2u);
+        EXL_CHECK(view.GetSectionHeader(2) == nullptr);
+        EXL_CHECK_EQ(view.GetSectionType(2), GLSLC_SECTION_TYPE_ENUM_LARGE);
+
+        /* The first GPU code section is the fallback when the stage isn't known. */
+        EXL_CHECK_EQ(view.FindGpuCode(NVN_SHADER_STAGE_LARGE).GetStage(), NVN_SHADER_STAGE_VERTEX);
+        EXL_CHECK_EQ(view.FindGpuCode(NVN_SHADER_STAGE_FRAGMENT).GetStage(), NVN_SHADER_STAGE_FRAGMENT);
+        EXL_CHECK(view.FindGpuCode(NVN_SHADER_STAGE_COMPUTE).GetHeader() == nullptr);
+
+        const GpuCodeView vertex = view.FindGpuCode(NVN_SHADER_STAGE_VERTEX);
+        EXL_CHECK(vertex.IsValid());
+        EXL_CHECK_EQ(vertex.GetControlSection().GetStage(), NVN_SHADER_STAGE_VERTEX);
+        EXL_CHECK_EQ(vertex.GetCode().GetSize(), 0x200u);
+
+        const ByteView shader = vertex.GetShader();
+        EXL_CHECK_EQ(shader.GetSize(), 0x150u);
+        EXL_CHECK_EQ(shader.GetData()[0], 0x30);
+
+        /* The program header is skipped for anything but compute. */
+        const ByteView shaderCode = vertex.GetShaderCode();
+        EXL_CHECK_EQ(shaderCode.GetSize(), 0x150u - GpuCodeView::ShaderProgramHeaderSize);
+        EXL_CHECK_EQ(shaderCode.GetData()[0], u8(0x30 + GpuCodeView::ShaderProgramHeaderSize));
+
+        const ByteView constbuf = vertex.GetConstbuf();
+        EXL_CHECK_EQ(constbuf.GetSize(), 0x40u);
+        EXL_CHECK_EQ(constbuf.GetData()[0], 0xc0);
+
+        EXL_CHECK(view.FindGpuCode(NVN_SHADER_STAGE_FRAGMENT).GetConstbuf().IsEmpty());
+    }
+
+    void TestCompute() {
+        TestOutput output({ { NVN_SHADER_STAGE_COMPUTE, 0x80, 0x10, 0x40 } });
+        const GpuCodeView compute = output.GetView().FindGpuCode(NVN_SHADER_STAGE_COMPUTE);
+        EXL_CHECK_EQ(compute.GetShaderCode().GetSize(), 0x40u);
+        EXL_CHECK(compute.GetShaderCode().GetData() == compute.GetShader().GetData());
+    }
+
+    void TestOutOfBounds() {
+        TestOutput output({
+            /* Shader runs past the code. */
+            { NVN_SHADER_STAGE_VERTEX, 0x100, 0xc0, 0x80, 0x0, 0x0 },
+            /* Shader is no bigger than its program header. */
+            { NVN_SHADER_STAGE_FRAGMENT, 0x100, 0x0, GpuCodeView::ShaderProgramHeaderSize },
+            /* Constants run past the code. */
+            { NVN_SHADER_STAGE_GEOMETRY, 0x100, 0x0, 0x80, 0xf0, 0x20 },
+            /* Control section too small to hold the fields. */
+            { NVN_SHADER_STAGE_TESS_CONTROL, 0x100, 0x0, 0x80, 0x0, 0x0, ControlSectionView::MinimumSize - 1 },
+        });
+        const GlslcOutputView view = output.GetView();
+
+        EXL_CHECK(view.FindGpuCode(NVN_SHADER_STAGE_VERTEX).GetShader().IsEmpty());
+        EXL_CHECK(view.FindGpuCode(NVN_SHADER_STAGE_VERTEX).GetShaderCode().IsEmpty());
+
+        const GpuCodeView fragment = view.FindGpuCode(NVN_SHADER_STAGE_FRAGMENT);
+        EXL_CHECK(!fragment.GetShader().IsEmpty());
+        EXL_CHECK(fragment.GetShaderCode().IsEmpty());
+
+        EXL_CHECK(view.FindGpuCode(NVN_SHADER_STAGE_GEOMETRY).GetConstbuf().IsEmpty());
+
+        const GpuCodeView tessControl = view.FindGpuCode(NVN_SHADER_STAGE_TESS_CONTROL);
+        EXL_CHECK(!tessControl.IsValid());
+        EXL_CHECK(tessControl.GetShader().IsEmpty());
+    }
+
+    void TestTruncatedOutput() {
+        TestOutput output({ { NVN_SHADER_STAGE_VERTEX, 0x100, 0x0, 0x80 } });
+
+        /* More sections than the blob has room for headers. */
+        output.GetOutput()->numSections = 0x1000;
+        EXL_CHECK(!output.GetView().IsValid());
+        EXL_CHECK_EQ(output.GetView().GetSectionCount(), 0u);
+        EXL_CHECK(output.GetView().FindGpuCode(NVN_SHADER_STAGE_LARGE).GetHeader() == nullptr);
+        output.GetOutput()->numSections = 1;
+
+        /* Sections are bounded by the size glslc recorded, not by where their headers point. */
+        output.GetOutput()->size = u32(output.GetSize() - 0x40);
+        const GpuCodeView vertex = output.GetView().FindGpuCode(NVN_SHADER_STAGE_VERTEX);
+        EXL_CHECK(vertex.GetCode().IsEmpty());
+        EXL_CHECK(vertex.GetShader().IsEmpty());
+
+        EXL_CHECK(!GlslcOutputView(nullptr).IsValid());
+        EXL_CHECK(!GlslcOutputView(output.GetBytes(), offsetof(GLSLCoutput, numSections)).IsValid());
+    }
+}
+
+int main() {
+    TestByteView();
+    TestOutputView();
+    TestCompute();
+    TestOutOfBounds();
+    TestTruncatedOutput();
+    return exl::test::Finish("glslc_view");
+}
\ No newline at end of file
@@ -0,0 +1,133 @@
+#include <rtld/relative_relocs.hpp>
+
+#include <initializer_list>
+#include <vector>
+
+#include "test.hpp"
+
+namespace {
+
+    /* Enough for a RELR address entry followed by a few bitmaps of 63 slots each. */
+    constexpr size_t SlotCount = 0x100;
+
+    /* Stands in for the module, relocations are relative to the start of the slots. */
+    struct Image {
+        std::vector<Elf64_Addr> m_Slots = std::vector<Elf64_Addr>(SlotCount);
+
+        Image() {
+            for(size_t i = 0; i < SlotCount; i++)
+                m_Slots[i] = 0x1000 + i * 0x10;
+        }
+
+        uintptr_t GetBase() const {
+            return reinterpret_cast<uintptr_t>(m_Slots.data());
+        }
+    };
+
+    /* Scatters the targets so consecutive entries don't hit consecutive slots. */
+    size_t GetTargetSlot(size_t index) {
+        return (index * 7 + 3) % SlotCount;
+    }
+
+    void TestRelativeRela() {
+        for(size_t count = 0; count <= 9; count++) {
+            Image image;
+            const Image original;
+            std::vector<Elf64_Rela> entries(count);
+            for(size_t i = 0; i < count; i++) {
+                /* The addend has nothing to do with what the slot held, RELA replaces it. */
+                entries[i] = { GetTargetSlot(i) * sizeof(Elf64_Addr), ELF64_R_INFO(0, R_AARCH64_RELATIVE), Elf64_Sxword(0x80000 + i * 0x18) };
+            }
+
+            rtld::apply_relative_rela(image.GetBase(), entries.data(), count);
+
+            std::vector<bool> touched(SlotCount);
+            for(size_t i = 0; i < count; i++) {
+                const size_t slot = GetTargetSlot(i);
+                touched[slot] = true;
+                EXL_CHECK_EQ(image.m_Slots[slot], image.GetBase() + 0x80000 + i * 0x18);
+            }
+            for(size_t i = 0; i < SlotCount; i++) {
+                if(!touched[i])
+                    EXL_CHECK_EQ(image.m_Slots[i], original.m_Slots[i]);
+            }
+        }
+    }
+
+    void TestRelativeRel() {
+        for(size_t count = 0; count <= 9; count++) {
+            Image image;
+            const Image original;
+            std::vector<Elf64_Rel> entries(count);
+            for(size_t i = 0; i < count; i++)
+                entries[i] = { GetTargetSlot(i) * sizeof(Elf64_Addr), ELF64_R_INFO(0, R_AARCH64_RELATIVE) };
+
+            rtld::apply_relative_rel(image.GetBase(), entries.data(), count);
+
+            /* REL keeps the addend in the slot itself. */
+            std::vector<bool> touched(SlotCount);
+            for(size_t i = 0; i < count; i++) {
+                const size_t slot = GetTargetSlot(i);
+                touched[slot] = true;
+                EXL_CHECK_EQ(image.m_Slots[slot], original.m_Slots[slot] + image.GetBase());
+            }
+            for(size_t i = 0; i < SlotCount; i++) {
+                if(!touched[i])
+                    EXL_CHECK_EQ(image.m_Slots[i], original.m_Slots[i]);
+            }
+        }
+    }
+
+    /* Applies a RELR stream and checks that exactly the given slots were relocated. */
+    void CheckRelr(std::initializer_list<Elf64_Addr> stream, std::initializer_list<size_t> slots) {
+        Image image;
+        const Image original;
+        const std::vector<Elf64_Addr> entries(stream);
+
+        rtld::apply_relr(image.GetBase(), entries.data(), entries.size() * sizeof(Elf64_Addr));
+
+        std::vector<bool> touched(SlotCount);
+        for(size_t slot : slots)
+            touched[slot] = true;
+        for(size_t i = 0; i < SlotCount; i++)
+            EXL_CHECK_EQ(image.m_Slots[i], original.m_Slots[i] + (touched[i] ? image.GetBase() : 0));
+    }
+
+    constexpr Elf64_Addr RelrAddress(size_t slot) {
+        return slot * sizeof(Elf64_Addr);
+    }
+
+    /* Bit 0 marks a bitmap, bit n relocates the n-1th slot after the current position. */
+    constexpr Elf64_Addr RelrBitmap(std::initializer_list<size_t> bits) {
+        Elf64_Addr value = 1;
+        for(size_t bit : bits)
+            value |= Elf64_Addr(1) << bit;
+        return value;
+    }
+
+    void TestRelr() {
+        CheckRelr({}, {});
+
+        /* A lone address relocates just that slot. */
+        CheckRelr({ RelrAddress(5) }, { 5 });
+
+        /* Every bitmap covers the 63 slots after the previous one. */
+        CheckRelr({ RelrAddress(2), RelrBitmap({ 1, 10 }), RelrBitmap({ 1, 63 }), RelrBitmap({ 5 }) }, { 2, 3, 12, 66, 128, 133 });
+
+        /* The highest bit is the last slot a bitmap covers. */
+        CheckRelr({ RelrAddress(0), RelrBitmap({ 63 }) }, { 0, 63 });
+
+        /* An empty bitmap still advances the position. */
+        CheckRelr({ RelrAddress(0), RelrBitmap({}), RelrBitmap({ 1 }) }, { 0, 64 });
+
+        /* A new address restarts the run. */
+        CheckRelr({ RelrAddress(10), RelrBitmap({ 2 }), RelrAddress(200), RelrBitmap({ 1, 3 }) }, { 10, 12, 200, 201, 203 });
+    }
+}
+
+int main() {
+    TestRelativeRela();
+    TestRelativeRel();
+    TestRelr();
+    return exl::test::Finish("relocation");
+}
\ No newline at end of file
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+
+#define EXL_CHECK(expr)                                                 \
+    do {                                                                \
+        if(!(expr))                                                     \
+            ::exl::test::Fail(__FILE__, __LINE__, #expr);               \
+    } while(0)
+
+#define EXL_CHECK_EQ(lhs, rhs)                                          \
+    do {                                                                \
+        auto _lhs = (lhs);                                              \
+        auto _rhs = (rhs);                                              \
+        if(!(_lhs == _rhs))                                             \
+            ::exl::test::FailEq(__FILE__, __LINE__, #lhs, #rhs,         \
+                uint64_t(_lhs), uint64_t(_rhs));                        \
+    } while(0)
+
+/* Minimal harness for the host tests. Checks keep going after a failure so one run reports everything. */
+namespace exl::test {
+
+    inline int s_Failures = 0;
+
+    inline void Fail(const char* file, int line, const char* expr) {
+        std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expr);
+        s_Failures++;
+    }
+
+    inline void FailEq(const char* file, int line, const char* lhs, const char* rhs, uint64_t lhsValue, uint64_t rhsValue) {
+        std::fprintf(stderr, "%s:%d: check failed: %s == %s (0x%" PRIx64 " != 0x%" PRIx64 ")\n", file, line, lhs, rhs, lhsValue, rhsValue);
+        s_Failures++;
+    }
+
+    inline int Finish(const char* name) {
+        if(s_Failures != 0) {
+            std::fprintf(stderr, "%s: %d check(s) failed\n", name, s_Failures);
+            return 1;
+        }
+        std::printf("%s: ok\n", name);
+        return 0;
+    }
+}
\ No newline at end of file
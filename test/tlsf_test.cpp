@@ -0,0 +1,253 @@
+#include <lib/alloc/tlsf.hpp>
+
+#include <algorithm>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "test.hpp"
+
+using exl::alloc::Tlsf;
+
+namespace {
+
+    constexpr size_t ArenaSize = 0x100000;
+
+    struct Arena {
+        std::vector<u64> m_Storage = std::vector<u64>(ArenaSize / sizeof(u64));
+        Tlsf m_Tlsf;
+
+        Arena() {
+            EXL_CHECK(m_Tlsf.Initialize(m_Storage.data(), ArenaSize));
+        }
+    };
+
+    struct Allocation {
+        u8* m_Ptr;
+        size_t m_Size;
+        u8 m_Fill;
+    };
+
+    bool IsAligned(const void* ptr, size_t align) {
+        return (reinterpret_cast<uintptr_t>(ptr) & (align - 1)) == 0;
+    }
+
+    bool HasFill(const Allocation& allocation) {
+        return std::all_of(allocation.m_Ptr, allocation.m_Ptr + allocation.m_Size, [&](u8 b) { return b == allocation.m_Fill; });
+    }
+
+    /* Every byte of the arena is accounted for, whatever state it's in. */
+    void CheckBalanced(const Tlsf& tlsf) {
+        const auto& stats = tlsf.GetStats();
+        EXL_CHECK_EQ(stats.m_UsedSize + stats.m_FreeSize, stats.m_ArenaSize);
+        EXL_CHECK(stats.m_PeakUsedSize >= stats.m_UsedSize);
+    }
+
+    void TestInitialize() {
+        u64 tiny[2];
+        Tlsf tlsf;
+        EXL_CHECK(!tlsf.Initialize(tiny, sizeof(tiny)));
+        EXL_CHECK(!tlsf.IsInitialized());
+        EXL_CHECK(tlsf.Allocate(0x10) == nullptr);
+
+        Arena arena;
+        const auto& stats = arena.m_Tlsf.GetStats();
+        EXL_CHECK(arena.m_Tlsf.IsInitialized());
+        EXL_CHECK(stats.m_ArenaSize > ArenaSize - 0x40);
+        EXL_CHECK_EQ(stats.m_FreeSize, stats.m_ArenaSize);
+        EXL_CHECK_EQ(stats.m_FreeBlockCount, 1u);
+        EXL_CHECK(arena.m_Tlsf.Contains(arena.m_Storage.data() + 4));
+        EXL_CHECK(!arena.m_Tlsf.Contains(arena.m_Storage.data() + arena.m_Storage.size()));
+    }
+
+    void TestAllocFree() {
+        Arena arena;
+        Tlsf& tlsf = arena.m_Tlsf;
+
+        void* a = tlsf.Allocate(1);
+        void* b = tlsf.Allocate(0x100);
+        void* c = tlsf.Allocate(0);
+        EXL_CHECK(a != nullptr && b != nullptr && c != nullptr);
+        EXL_CHECK(IsAligned(a, Tlsf::Alignment) && IsAligned(b, Tlsf::Alignment) && IsAligned(c, Tlsf::Alignment));
+        EXL_CHECK(tlsf.GetAllocationSize(b) >= 0x100);
+        EXL_CHECK_EQ(tlsf.GetStats().m_AllocCount, 3u);
+        CheckBalanced(tlsf);
+
+        /* Freeing the middle block, then its neighbours, has to coalesce back into a single block. */
+        tlsf.Free(b);
+        tlsf.Free(a);
+        tlsf.Free(c);
+        tlsf.Free(nullptr);
+        const auto& stats = tlsf.GetStats();
+        EXL_CHECK_EQ(stats.m_UsedSize, 0u);
+        EXL_CHECK_EQ(stats.m_FreeBlockCount, 1u);
+        EXL_CHECK_EQ(stats.m_FreeCount, 3u);
+        EXL_CHECK(stats.m_PeakUsedSize >= 0x100);
+        CheckBalanced(tlsf);
+
+        /* The whole arena is usable again. */
+        void* all = tlsf.Allocate(stats.m_ArenaSize - 0x20);
+        EXL_CHECK(all != nullptr);
+        tlsf.Free(all);
+    }
+
+    void TestAlignment() {
+        Arena arena;
+        Tlsf& tlsf = arena.m_Tlsf;
+
+        std::vector<void*> ptrs;
+        for(size_t align = Tlsf::Alignment; align <= 0x4000; align <<= 1) {
+            /* Odd sizes in between, so the aligned blocks don't start at convenient offsets. */
+            ptrs.push_back(tlsf.Allocate(0x30));
+            void* ptr = tlsf.Allocate(0x48, align);
+            EXL_CHECK(ptr != nullptr);
+            EXL_CHECK(IsAligned(ptr, align));
+            ptrs.push_back(ptr);
+            CheckBalanced(tlsf);
+        }
+
+        EXL_CHECK(tlsf.Allocate(0x10, 0x30) == nullptr);
+        EXL_CHECK(tlsf.Allocate(size_t(1) << 40) == nullptr);
+        EXL_CHECK_EQ(tlsf.GetStats().m_FailCount, 2u);
+
+        for(void* ptr : ptrs)
+            tlsf.Free(ptr);
+        EXL_CHECK_EQ(tlsf.GetStats().m_UsedSize, 0u);
+        EXL_CHECK_EQ(tlsf.GetStats().m_FreeBlockCount, 1u);
+    }
+
+    void TestReallocate() {
+        Arena arena;
+        Tlsf& tlsf = arena.m_Tlsf;
+
+        EXL_CHECK(tlsf.Reallocate(nullptr, 0x20) != nullptr);
+
+        Allocation a = { static_cast<u8*>(tlsf.Allocate(0x40)), 0x40, 0xa5 };
+        std::fill_n(a.m_Ptr, a.m_Size, a.m_Fill);
+
+        /* Nothing follows, so it grows in place. */
+        u8* grown = static_cast<u8*>(tlsf.Reallocate(a.m_Ptr, 0x400));
+        EXL_CHECK(grown == a.m_Ptr);
+        EXL_CHECK(HasFill(a));
+        CheckBalanced(tlsf);
+
+        /* Blocked by another allocation, so it has to move and keep its contents. */
+        void* blocker = tlsf.Allocate(0x10);
+        std::fill_n(grown, 0x400, a.m_Fill);
+        a = { static_cast<u8*>(tlsf.Reallocate(grown, 0x800)), 0x400, a.m_Fill };
+        EXL_CHECK(a.m_Ptr != nullptr && a.m_Ptr != grown);
+        EXL_CHECK(HasFill(a));
+        CheckBalanced(tlsf);
+
+        /* Shrinking stays in place and gives the tail back. */
+        const size_t freeBefore = tlsf.GetStats().m_FreeSize;
+        EXL_CHECK(tlsf.Reallocate(a.m_Ptr, 0x100) == a.m_Ptr);
+        EXL_CHECK(tlsf.GetStats().m_FreeSize > freeBefore);
+        a.m_Size = 0x100;
+        EXL_CHECK(HasFill(a));
+        CheckBalanced(tlsf);
+
+        EXL_CHECK(tlsf.Reallocate(a.m_Ptr, ArenaSize * 2) == nullptr);
+        EXL_CHECK(HasFill(a));
+
+        EXL_CHECK(tlsf.Reallocate(a.m_Ptr, 0) == nullptr);
+        tlsf.Free(blocker);
+        CheckBalanced(tlsf);
+    }
+
+    void TestExhaustion() {
+        Arena arena;
+        Tlsf& tlsf = arena.m_Tlsf;
+
+        std::vector<void*> ptrs;
+        for(;;) {
+            void* ptr = tlsf.Allocate(0x1000);
+            if(ptr == nullptr)
+                break;
+            ptrs.push_back(ptr);
+        }
+        EXL_CHECK(ptrs.size() >= ArenaSize / 0x1010 - 1);
+        EXL_CHECK_EQ(tlsf.GetStats().m_FailCount, 1u);
+        EXL_CHECK(tlsf.GetStats().m_FreeSize < 0x1010);
+        CheckBalanced(tlsf);
+
+        /* Small requests still fit in what's left over. */
+        void* small = tlsf.Allocate(0x10);
+        if(small != nullptr)
+            ptrs.push_back(small);
+
+        /* Freeing every other block doesn't make room for anything bigger. */
+        for(size_t i = 0; i < ptrs.size(); i += 2)
+            tlsf.Free(std::exchange(ptrs[i], nullptr));
+        EXL_CHECK(tlsf.Allocate(0x2000) == nullptr);
+
+        for(void* ptr : ptrs)
+            tlsf.Free(ptr);
+        EXL_CHECK_EQ(tlsf.GetStats().m_FreeBlockCount, 1u);
+        EXL_CHECK(tlsf.Allocate(ArenaSize / 2) != nullptr);
+        CheckBalanced(tlsf);
+    }
+
+    /* Random operations against a list of live allocations, checking contents and accounting as it goes. */
+    void TestRandom() {
+        Arena arena;
+        Tlsf& tlsf = arena.m_Tlsf;
+        std::mt19937 random(0x7154);
+        std::vector<Allocation> live;
+
+        for(int i = 0; i < 200000; i++) {
+            const u32 op = random() % 8;
+            if(op < 4 || live.empty()) {
+                const size_t size = random() % 4 == 0 ? random() % 0x4000 : random() % 0x100;
+                const size_t align = random() % 8 == 0 ? size_t(0x10) << (random() % 8) : Tlsf::Alignment;
+                u8* ptr = static_cast<u8*>(tlsf.Allocate(size, align));
+                if(ptr == nullptr)
+                    continue;
+                EXL_CHECK(IsAligned(ptr, align));
+                EXL_CHECK(tlsf.GetAllocationSize(ptr) >= size);
+                live.push_back({ ptr, size, u8(random()) });
+                std::fill_n(ptr, size, live.back().m_Fill);
+            } else if(op < 7) {
+                const size_t index = random() % live.size();
+                EXL_CHECK(HasFill(live[index]));
+                tlsf.Free(live[index].m_Ptr);
+                live[index] = live.back();
+                live.pop_back();
+            } else {
+                Allocation& allocation = live[random() % live.size()];
+                const size_t size = 1 + random() % 0x2000;
+                u8* ptr = static_cast<u8*>(tlsf.Reallocate(allocation.m_Ptr, size));
+                if(ptr == nullptr) {
+                    EXL_CHECK(HasFill(allocation));
+                    continue;
+                }
+                allocation.m_Ptr = ptr;
+                allocation.m_Size = std::min(allocation.m_Size, size);
+                EXL_CHECK(HasFill(allocation));
+                std::fill_n(ptr, size, allocation.m_Fill);
+                allocation.m_Size = size;
+            }
+
+            if(i % 1000 == 0)
+                CheckBalanced(tlsf);
+        }
+
+        for(const auto& allocation : live) {
+            EXL_CHECK(HasFill(allocation));
+            tlsf.Free(allocation.m_Ptr);
+        }
+        EXL_CHECK_EQ(tlsf.GetStats().m_UsedSize, 0u);
+        EXL_CHECK_EQ(tlsf.GetStats().m_FreeBlockCount, 1u);
+        CheckBalanced(tlsf);
+    }
+}
+
+int main() {
+    TestInitialize();
+    TestAllocFree();
+    TestAlignment();
+    TestReallocate();
+    TestExhaustion();
+    TestRandom();
+    return exl::test::Finish("tlsf");
+}
\ No newline at end of file